@@ -34,6 +34,19 @@ CommandLineParserResult CommandLineParser::parse(int argc, char* argv[])
       result.workdir = std::string(argv[i]);
       ++i;
     }
+    else if (opt == "--save-model" || opt == "--load-model")
+    {
+      if (i + 1 == argc)
+      {
+        result.status = CommandLineParserResult::ParseError;
+        result.error = "Missing file name after " + opt;
+        return result;
+      }
+
+      result.status = CommandLineParserResult::Work;
+      (opt == "--save-model" ? result.save_model : result.load_model) = std::string(argv[i + 1]);
+      i += 2;
+    }
     else if (opt == "-v" || opt == "--version")
     {
       result.status = CommandLineParserResult::VersionRequested;
@@ -62,9 +75,11 @@ std::string CommandLineParser::help() const
   help += "Usage: dex [options]\n";
   help += "\n";
   help += "Options:\n";
-  help += "  -?, -h, --help  Displays help on commandline options.\n";
-  help += "  -v, --version   Displays version information.\n";
-  help += "  -w <workdir>    Working directory\n";
+  help += "  -?, -h, --help        Displays help on commandline options.\n";
+  help += "  -v, --version         Displays version information.\n";
+  help += "  -w <workdir>          Working directory\n";
+  help += "  --save-model <file>   Saves a snapshot of the parsed model\n";
+  help += "  --load-model <file>   Uses a model snapshot instead of parsing the inputs\n";
 
   return help;
 }
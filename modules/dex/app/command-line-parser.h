@@ -28,6 +28,8 @@ struct CommandLineParserResult
   Status status = HelpRequested;
   std::string error;
   std::optional<std::string> workdir;
+  std::optional<std::string> save_model;
+  std::optional<std::string> load_model;
 };
 
 class DEX_APP_API CommandLineParser
@@ -7,6 +7,8 @@
 #include "dex/app/message-handler.h"
 #include "dex/app/parsing.h"
 
+#include "dex/model/model-snapshot.h"
+
 #include "dex/output/exporter.h"
 
 #include <json-toolkit/json.h>
@@ -42,6 +44,13 @@ Dex::Dex(const CommandLineParserResult& arguments)
 {
   if (arguments.workdir.has_value())
     m_workdir = arguments.workdir.value();
+
+  // relative to the current directory, not to the working dir
+  if (arguments.save_model.has_value())
+    m_save_model = std::filesystem::absolute(arguments.save_model.value());
+
+  if (arguments.load_model.has_value())
+    m_load_model = std::filesystem::absolute(arguments.load_model.value());
 }
 
 Dex::Dex(const std::filesystem::path& workdir)
@@ -89,6 +98,18 @@ void Dex::parseInputs()
   m_model = dex::parse_inputs(m_config.inputs, m_config.suffixes);
 }
 
+void Dex::loadModel(const std::filesystem::path& file)
+{
+  log::info() << "Loading model from '" << file.string() << "'";
+  m_model = dex::snapshot::load(file);
+}
+
+void Dex::saveModel(const std::filesystem::path& file)
+{
+  log::info() << "Saving model to '" << file.string() << "'";
+  dex::snapshot::save(*m_model, file);
+}
+
 void Dex::writeOutput()
 {
   write_output(m_model, m_config.output, m_config.variables);
@@ -118,7 +139,14 @@ void Dex::work()
     log::info() << "Could not parse dex.yml config";
   }
 
-  parseInputs();
+  if (m_load_model.has_value())
+    loadModel(m_load_model.value());
+  else
+    parseInputs();
+
+  if (m_save_model.has_value())
+    saveModel(m_save_model.value());
+
   writeOutput();
 }
 
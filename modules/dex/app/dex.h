@@ -14,6 +14,7 @@
 #include "dex/model/model.h"
 
 #include <filesystem>
+#include <optional>
 
 namespace dex
 {
@@ -32,6 +33,8 @@ public:
 
   void readConfig();
   void parseInputs();
+  void loadModel(const std::filesystem::path& file);
+  void saveModel(const std::filesystem::path& file);
   void writeOutput();
 
 protected:
@@ -42,6 +45,8 @@ protected:
   
 private:
   std::filesystem::path m_workdir;
+  std::optional<std::filesystem::path> m_save_model;
+  std::optional<std::filesystem::path> m_load_model;
   Config m_config;
   std::shared_ptr<Model> m_model;
 };
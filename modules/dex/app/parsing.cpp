@@ -8,6 +8,8 @@
 
 #include "dex/input/parser-machine.h"
 
+#include "dex/common/string-pool.h"
+
 #include <json-toolkit/json.h>
 
 #include <iostream>
@@ -101,6 +103,10 @@ std::shared_ptr<Model> parse_inputs(const std::set<std::string>& inputs, const s
     feed_machine(context, std::filesystem::current_path());
   }
 
+  StringPool::Statistics stats = StringPool::global().statistics();
+  log::info() << "String pool: " << stats.strings << " strings (" << stats.bytes << " bytes) for "
+    << stats.requests << " requests, " << stats.savedBytes() << " bytes saved";
+
   return context.machine.output();
 }
 
@@ -9,6 +9,15 @@
 #include <fstream>
 #include <sstream>
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
 namespace dex
 {
 
@@ -62,6 +71,94 @@ void crlf2lf(std::string& str)
   str.resize(w);
 }
 
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& p)
+{
+  m_file = CreateFileW(p.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (m_file == INVALID_HANDLE_VALUE)
+  {
+    m_file = nullptr;
+    throw IOException{ p.string(), "could not open file for reading" };
+  }
+
+  LARGE_INTEGER size;
+  GetFileSizeEx(m_file, &size);
+  m_size = static_cast<size_t>(size.QuadPart);
+
+  if (m_size == 0)
+    return;
+
+  m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  m_data = m_mapping ? static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+  if (!m_data)
+  {
+    if (m_mapping)
+      CloseHandle(m_mapping);
+
+    CloseHandle(m_file);
+    throw IOException{ p.string(), "could not map file" };
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+
+  if (m_mapping)
+    CloseHandle(m_mapping);
+
+  if (m_file)
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& p)
+{
+  m_fd = ::open(p.c_str(), O_RDONLY);
+
+  if (m_fd == -1)
+    throw IOException{ p.string(), "could not open file for reading" };
+
+  struct stat st;
+
+  if (::fstat(m_fd, &st) != 0)
+  {
+    ::close(m_fd);
+    throw IOException{ p.string(), "could not stat file" };
+  }
+
+  m_size = static_cast<size_t>(st.st_size);
+
+  if (m_size == 0)
+    return;
+
+  void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+
+  if (addr == MAP_FAILED)
+  {
+    ::close(m_fd);
+    throw IOException{ p.string(), "could not map file" };
+  }
+
+  m_data = static_cast<const char*>(addr);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    ::munmap(const_cast<char*>(m_data), m_size);
+
+  if (m_fd != -1)
+    ::close(m_fd);
+}
+
+#endif // _WIN32
+
 } // namespace file_utils
 
 } // namespace dex
@@ -22,6 +22,40 @@ DEX_COMMON_API void write_file(const std::filesystem::path& p, const std::string
 DEX_COMMON_API void remove(const std::filesystem::path& p);
 DEX_COMMON_API void crlf2lf(std::string& str);
 
+// Read-only memory mapping of a whole file
+class DEX_COMMON_API MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path& p);
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  const char* data() const;
+  size_t size() const;
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#else
+  int m_fd = -1;
+#endif // _WIN32
+};
+
+inline const char* MappedFile::data() const
+{
+  return m_data;
+}
+
+inline size_t MappedFile::size() const
+{
+  return m_size;
+}
+
 } // namespace file_utils
 
 } // namespace dex
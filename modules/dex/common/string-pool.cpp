@@ -0,0 +1,182 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/common/string-pool.h"
+
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+
+namespace dex
+{
+
+size_t StringPool::Statistics::savedBytes() const
+{
+  const size_t used = bytes + requests * sizeof(const std::string*);
+  return requested_bytes > used ? requested_bytes - used : 0;
+}
+
+static std::atomic<size_t> g_pool_ids{ 0 };
+
+StringPool::StringPool()
+  : m_id(g_pool_ids++)
+{
+
+}
+
+StringPool::~StringPool()
+{
+
+}
+
+StringPool& StringPool::global()
+{
+  static StringPool static_instance;
+  return static_instance;
+}
+
+StringPool::Shard& StringPool::shard(const std::string& str)
+{
+  return m_shards[std::hash<std::string>()(str) % ShardCount];
+}
+
+const StringPool::Shard& StringPool::shard(const std::string& str) const
+{
+  return m_shards[std::hash<std::string>()(str) % ShardCount];
+}
+
+// Pools are identified by id rather than address, another pool may be
+// created at the address of a destroyed one.
+StringPool::Counters& StringPool::counters()
+{
+  thread_local std::vector<std::pair<size_t, std::shared_ptr<Counters>>> static_counters;
+
+  for (const auto& entry : static_counters)
+  {
+    if (entry.first == m_id)
+      return *entry.second;
+  }
+
+  auto result = std::make_shared<Counters>();
+
+  {
+    std::lock_guard<std::mutex> lock{ m_counters_mutex };
+    m_counters.push_back(result);
+  }
+
+  static_counters.emplace_back(m_id, result);
+  return *result;
+}
+
+void StringPool::count(const std::string& str)
+{
+  // a plain load and store, no other thread writes these counters
+  Counters& c = counters();
+  c.requests.store(c.requests.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  c.requested_bytes.store(c.requested_bytes.load(std::memory_order_relaxed) + sizeof(std::string) + str.size(), std::memory_order_relaxed);
+}
+
+const std::string* StringPool::intern(const std::string& str)
+{
+  count(str);
+
+  Shard& sh = shard(str);
+
+  {
+    std::shared_lock<std::shared_mutex> lock{ sh.mutex };
+    auto it = sh.strings.find(str);
+
+    if (it != sh.strings.end())
+      return &(*it);
+  }
+
+  std::unique_lock<std::shared_mutex> lock{ sh.mutex };
+  auto inserted = sh.strings.insert(str);
+
+  if (inserted.second)
+    sh.bytes += sizeof(std::string) + str.size();
+
+  return &(*inserted.first);
+}
+
+const std::string* StringPool::find(const std::string& str) const
+{
+  const Shard& sh = shard(str);
+  std::shared_lock<std::shared_mutex> lock{ sh.mutex };
+  auto it = sh.strings.find(str);
+  return it != sh.strings.end() ? &(*it) : nullptr;
+}
+
+StringPool::Statistics StringPool::statistics() const
+{
+  Statistics result;
+
+  for (const Shard& sh : m_shards)
+  {
+    std::shared_lock<std::shared_mutex> lock{ sh.mutex };
+    result.strings += sh.strings.size();
+    result.bytes += sh.bytes;
+  }
+
+  std::lock_guard<std::mutex> lock{ m_counters_mutex };
+
+  for (const auto& c : m_counters)
+  {
+    result.requests += c->requests.load(std::memory_order_relaxed);
+    result.requested_bytes += c->requested_bytes.load(std::memory_order_relaxed);
+  }
+
+  return result;
+}
+
+static const std::string* empty_string()
+{
+  static const std::string* static_instance = StringPool::global().intern(std::string());
+  return static_instance;
+}
+
+InternedString::InternedString()
+  : m_str(empty_string())
+{
+
+}
+
+// Strings of the global pool already interned by the calling thread.
+// The pool outlives the handles, the keys view the pooled strings.
+const std::string* InternedString::intern(const std::string& str)
+{
+  thread_local std::unordered_map<std::string_view, const std::string*> cache;
+
+  auto it = cache.find(std::string_view(str));
+
+  if (it != cache.end())
+  {
+    StringPool::global().count(str);
+    return it->second;
+  }
+
+  const std::string* result = StringPool::global().intern(str);
+  cache.emplace(std::string_view(*result), result);
+  return result;
+}
+
+InternedString::InternedString(const std::string& str)
+  : m_str(str.empty() ? empty_string() : intern(str))
+{
+
+}
+
+InternedString::InternedString(const char* str)
+  : InternedString(std::string(str))
+{
+
+}
+
+std::ostream& operator<<(std::ostream& out, const InternedString& str)
+{
+  return out << str.str();
+}
+
+} // namespace dex
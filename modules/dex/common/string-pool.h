@@ -0,0 +1,225 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_COMMON_STRINGPOOL_H
+#define DEX_COMMON_STRINGPOOL_H
+
+#include "dex/dex-common.h"
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace dex
+{
+
+// Stores each distinct string once; returned pointers stay valid for
+// the lifetime of the pool.
+// The strings are spread over shards, each with a reader-writer lock:
+// looking up a string that is already in the pool only takes a shared
+// lock, so concurrent lookups do not serialize.
+// Requests are counted per thread and summed by statistics().
+class DEX_COMMON_API StringPool
+{
+public:
+  StringPool();
+  StringPool(const StringPool&) = delete;
+  ~StringPool();
+
+  static StringPool& global();
+
+  const std::string* intern(const std::string& str);
+  const std::string* find(const std::string& str) const;
+
+  struct Statistics
+  {
+    size_t strings = 0;
+    size_t bytes = 0;
+    size_t requests = 0;
+    size_t requested_bytes = 0;
+
+    size_t savedBytes() const;
+  };
+
+  Statistics statistics() const;
+
+  StringPool& operator=(const StringPool&) = delete;
+
+protected:
+  void count(const std::string& str);
+
+private:
+  friend class InternedString;
+
+  static constexpr size_t ShardCount = 16;
+
+  struct Shard
+  {
+    mutable std::shared_mutex mutex;
+    std::unordered_set<std::string> strings;
+    size_t bytes = 0;
+  };
+
+  Shard& shard(const std::string& str);
+  const Shard& shard(const std::string& str) const;
+
+  // only written by their thread
+  struct Counters
+  {
+    std::atomic<size_t> requests{ 0 };
+    std::atomic<size_t> requested_bytes{ 0 };
+  };
+
+  Counters& counters();
+
+  Shard m_shards[ShardCount];
+  size_t m_id;
+  mutable std::mutex m_counters_mutex;
+  std::vector<std::shared_ptr<Counters>> m_counters;
+};
+
+// Handle to a string of the global pool: one pointer wide, compared by
+// address against other interned strings.
+// Each thread remembers the strings it has interned, constructing a
+// handle to one of them takes no lock.
+class DEX_COMMON_API InternedString
+{
+public:
+  InternedString();
+  InternedString(const InternedString&) = default;
+  InternedString(const std::string& str);
+  InternedString(const char* str);
+
+  const std::string& str() const;
+  operator const std::string&() const;
+
+  bool empty() const;
+  size_t size() const;
+  size_t length() const;
+  const char* c_str() const;
+
+  InternedString& operator=(const InternedString&) = default;
+
+private:
+  static const std::string* intern(const std::string& str);
+
+private:
+  const std::string* m_str;
+};
+
+inline const std::string& InternedString::str() const
+{
+  return *m_str;
+}
+
+inline InternedString::operator const std::string&() const
+{
+  return *m_str;
+}
+
+inline bool InternedString::empty() const
+{
+  return m_str->empty();
+}
+
+inline size_t InternedString::size() const
+{
+  return m_str->size();
+}
+
+inline size_t InternedString::length() const
+{
+  return m_str->length();
+}
+
+inline const char* InternedString::c_str() const
+{
+  return m_str->c_str();
+}
+
+inline bool operator==(const InternedString& lhs, const InternedString& rhs)
+{
+  return &lhs.str() == &rhs.str();
+}
+
+inline bool operator!=(const InternedString& lhs, const InternedString& rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline bool operator==(const InternedString& lhs, const std::string& rhs)
+{
+  return lhs.str() == rhs;
+}
+
+inline bool operator!=(const InternedString& lhs, const std::string& rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline bool operator==(const std::string& lhs, const InternedString& rhs)
+{
+  return lhs == rhs.str();
+}
+
+inline bool operator!=(const std::string& lhs, const InternedString& rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline bool operator==(const InternedString& lhs, const char* rhs)
+{
+  return lhs.str() == rhs;
+}
+
+inline bool operator!=(const InternedString& lhs, const char* rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline bool operator==(const char* lhs, const InternedString& rhs)
+{
+  return rhs == lhs;
+}
+
+inline bool operator!=(const char* lhs, const InternedString& rhs)
+{
+  return !(rhs == lhs);
+}
+
+inline bool operator<(const InternedString& lhs, const InternedString& rhs)
+{
+  return lhs.str() < rhs.str();
+}
+
+inline std::string operator+(const std::string& lhs, const InternedString& rhs)
+{
+  return lhs + rhs.str();
+}
+
+inline std::string operator+(const InternedString& lhs, const std::string& rhs)
+{
+  return lhs.str() + rhs;
+}
+
+inline std::string operator+(const char* lhs, const InternedString& rhs)
+{
+  return lhs + rhs.str();
+}
+
+inline std::string operator+(const InternedString& lhs, const char* rhs)
+{
+  return lhs.str() + rhs;
+}
+
+DEX_COMMON_API std::ostream& operator<<(std::ostream& out, const InternedString& str);
+
+} // namespace dex
+
+#endif // DEX_COMMON_STRINGPOOL_H
@@ -737,7 +737,7 @@ std::shared_ptr<Function> CppParser::parseFunctionSignature()
 
     if (peek() == cpptok::TokenType::LeftPar)
     {
-      fun_name = return_type;
+      fun_name = return_type.str();
       return_type = "";
       category = FunctionKind::Constructor;
     }
@@ -195,6 +195,8 @@ void ParagraphWriter::finish()
         data->range() = dex::ParagraphRange(parrange.paragraph(), parrange.begin(), par.length());
       }
     }
+
+    par.updateSpans();
   }
 }
 
@@ -18,27 +18,14 @@ namespace dex
 {
 
 template<typename T>
-std::shared_ptr<T> find(const dex::Entity& e, const std::string& name)
+std::shared_ptr<T> find(const dex::SymbolTable& symbols, const dex::Entity& scope, const std::string& name)
 {
-  if (e.kind() == model::Kind::Class)
-  {
-    const dex::Class& cla = static_cast<const dex::Class&>(e);
+  const std::string prefix = symbols.qualifiedName(scope);
 
-    for (auto m : cla.members)
-    {
-      if (m->name == name)
-        return std::dynamic_pointer_cast<T>(m);
-    }
-  }
-  else if (e.kind() == model::Kind::Namespace)
+  for (const auto& e : symbols.lookup(prefix.empty() ? name : prefix + "::" + name))
   {
-    const dex::Namespace& ns = static_cast<const dex::Namespace&>(e);
-
-    for (auto child : ns.entities)
-    {
-      if (child->name == name)
-        return std::dynamic_pointer_cast<T>(child);
-    }
+    if (e->is<T>())
+      return std::static_pointer_cast<T>(e);
   }
 
   return nullptr;
@@ -100,7 +87,7 @@ void ProgramParser::class_(std::string name)
 
   auto parent = std::dynamic_pointer_cast<dex::Entity>(currentFrame().node);
 
-  auto the_class = find<dex::Class>(*static_cast<dex::Entity*>(currentFrame().node.get()), name);
+  auto the_class = find<dex::Class>(m_program->symbols, *currentFrame().node, name);
 
   if (the_class == nullptr)
   {
@@ -174,7 +161,7 @@ void ProgramParser::namespace_(std::string name)
 
   auto parent_ns = std::dynamic_pointer_cast<dex::Namespace>(currentFrame().node);
 
-  auto the_namespace = find<dex::Namespace>(*static_cast<dex::Entity*>(currentFrame().node.get()), name);
+  auto the_namespace = find<dex::Namespace>(m_program->symbols, *currentFrame().node, name);
 
   if (the_namespace == nullptr)
   {
@@ -206,16 +193,7 @@ void ProgramParser::enum_(std::string name)
 
   auto new_enum = std::make_shared<dex::Enum>(std::move(name), parent_entity);
 
-  if (parent_entity->is<dex::Namespace>())
-  {
-    const auto ns = std::static_pointer_cast<dex::Namespace>(parent_entity);
-    ns->entities.push_back(new_enum);
-  }
-  else
-  {
-    const auto cla = std::static_pointer_cast<dex::Class>(parent_entity);
-    cla->members.push_back(new_enum);
-  }
+  appendChild(parent_entity, new_enum);
 
   state().enter<FrameType::Enum>(new_enum);
 
@@ -262,7 +240,7 @@ void ProgramParser::value(std::string name)
 
   auto enum_value = std::make_shared<dex::EnumValue>(std::move(name), en);
 
-  en->values.push_back(enum_value);
+  appendChild(en, enum_value);
 
   // TODO: handle optional since clause
 
@@ -304,16 +282,7 @@ void ProgramParser::variable(std::string decl)
     }
   }();
 
-  if (parent_entity->is<dex::Namespace>())
-  {
-    const auto ns = std::static_pointer_cast<dex::Namespace>(parent_entity);
-    ns->entities.push_back(the_var);
-  }
-  else
-  {
-    const auto cla = std::static_pointer_cast<dex::Class>(parent_entity);
-    cla->members.push_back(the_var);
-  }
+  appendChild(parent_entity, the_var);
 
   m_state.enter<FrameType::Variable>(the_var);
 }
@@ -355,16 +324,7 @@ void ProgramParser::typedef_(std::string decl)
     }
   }();
 
-  if (parent_entity->is<dex::Namespace>())
-  {
-    const auto ns = std::static_pointer_cast<dex::Namespace>(parent_entity);
-    ns->entities.push_back(the_typedef);
-  }
-  else
-  {
-    const auto cla = std::static_pointer_cast<dex::Class>(parent_entity);
-    cla->members.push_back(the_typedef);
-  }
+  appendChild(parent_entity, the_typedef);
 
   m_state.enter<FrameType::Typedef>(the_typedef);
 }
@@ -475,6 +435,7 @@ void ProgramParser::nonmember()
 
   // perform the re-parenting
   the_class->members.pop_back();
+  m_program->symbols.remove(func);
   appendChild(the_class->parent(), func);
 
   m_program->related.relates(func, the_class);
@@ -587,6 +548,8 @@ void ProgramParser::appendChild(std::shared_ptr<dex::Entity> parent, std::shared
   }
   
   child->weak_parent = std::static_pointer_cast<dex::Entity>(parent);
+
+  m_program->symbols.insert(child);
 }
 
 } // namespace dex
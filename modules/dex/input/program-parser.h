@@ -105,7 +105,7 @@ protected:
   void exitGhost();
   void exitFrame();
   void appendChild(std::shared_ptr<Entity> e);
-  static void appendChild(std::shared_ptr<Entity> parent, std::shared_ptr<Entity> child);
+  void appendChild(std::shared_ptr<Entity> parent, std::shared_ptr<Entity> child);
 
 private:
   ParserMachine& m_machine;
@@ -69,13 +69,7 @@ bool DocumentElement::isDocumentElement() const
 
 static size_t find_iterator_end(const Paragraph& p, size_t self_begin)
 {
-  const size_t par_metadata_end = p.metadata().at(self_begin)->range().end();
-  size_t self_end = self_begin;
-
-  while (self_end < p.metadata().size() && p.metadata().at(self_end)->range().end() <= par_metadata_end)
-    ++self_end;
-
-  return self_end;
+  return p.spans()[self_begin].next;
 }
 
 ParagraphIterator::ParagraphIterator(const Paragraph& p)
@@ -83,7 +77,7 @@ ParagraphIterator::ParagraphIterator(const Paragraph& p)
   m_parent_index(p.metadata().size()),
   m_index(0)
 {
-  m_text = p.metadata().empty() || p.metadata().front()->range().begin() > 0;
+  m_text = p.spans().empty() || p.spans().front().begin > 0;
 }
 
 ParagraphIterator::ParagraphIterator(const Paragraph& p, size_t parent_index)
@@ -112,64 +106,27 @@ const Paragraph& ParagraphIterator::paragraph() const
 
 ParagraphRange ParagraphIterator::range() const
 {
-  if (paragraph().metadata().empty())
+  const std::vector<Paragraph::Span>& spans = paragraph().spans();
+
+  if (spans.empty())
     return ParagraphRange{ paragraph() };
 
+  if (!m_text)
+    return paragraph().metadata()[m_index]->range();
+
   if (!isChild())
   {
-    if (m_text)
-    {
-      if (m_index == 0)
-      {
-        return ParagraphRange{ paragraph(), 0, paragraph().metadata().at(0)->range().begin() };
-      }
-      else if (m_index == paragraph().metadata().size())
-      {
-        const size_t begin = paragraph().metadata().at(m_index - 1)->range().end();
-        const size_t end = paragraph().length();
-        return ParagraphRange{ paragraph(), begin, end };
-      }
-      else
-      {
-        const size_t begin = paragraph().metadata().at(m_index - 1)->range().end();
-        const size_t end = paragraph().metadata().at(m_index)->range().begin();
-        return ParagraphRange{ paragraph(), begin, end };
-      }
-    }
-    else
-    {
-      return paragraph().metadata().at(m_index)->range();
-    }
+    const size_t begin = m_index == 0 ? 0 : spans[m_index - 1].end;
+    const size_t end = m_index == spans.size() ? paragraph().length() : spans[m_index].begin;
+    return ParagraphRange{ paragraph(), begin, end };
   }
   else
   {
-    if (m_text)
-    {
-      const size_t end_index = find_iterator_end(paragraph(), m_parent_index);
-
-      if (m_index == m_parent_index + 1)
-      {
-        const size_t begin = paragraph().metadata().at(m_parent_index)->range().begin();
-        const size_t end = paragraph().metadata().at(m_index)->range().begin();
-        return ParagraphRange{ paragraph(), begin, end };
-      }
-      else if (m_index == end_index)
-      {
-        const size_t begin = paragraph().metadata().at(m_index - 1)->range().end();
-        const size_t end = paragraph().metadata().at(m_parent_index)->range().end();;
-        return ParagraphRange{ paragraph(), begin, end };
-      }
-      else
-      {
-        const size_t begin = paragraph().metadata().at(m_index - 1)->range().end();
-        const size_t end = paragraph().metadata().at(m_index)->range().begin();
-        return ParagraphRange{ paragraph(), begin, end };
-      }
-    }
-    else
-    {
-      return paragraph().metadata().at(m_index)->range();
-    }
+    const Paragraph::Span& parent = spans[m_parent_index];
+
+    const size_t begin = m_index == m_parent_index + 1 ? parent.begin : spans[m_index - 1].end;
+    const size_t end = m_index == parent.next ? parent.end : spans[m_index].begin;
+    return ParagraphRange{ paragraph(), begin, end };
   }
 }
 
@@ -204,11 +161,7 @@ ParagraphIterator ParagraphIterator::begin() const
 
 ParagraphIterator ParagraphIterator::end() const
 {
-  ParagraphIterator it{ paragraph() };
-  it.m_text = false;
-  it.m_parent_index = m_index;
-  it.m_index = find_iterator_end(paragraph(), m_index);
-  return it;
+  return ParagraphIterator{ paragraph(), m_index, find_iterator_end(paragraph(), m_index), false };
 }
 
 ParagraphIterator& ParagraphIterator::operator++()
@@ -224,10 +177,11 @@ ParagraphIterator& ParagraphIterator::operator++()
     m_text = true;
     m_index = find_iterator_end(paragraph(), m_index);
 
-    if (range().end() - range().begin() == 0)
-    {
-      ++(*this);
-    }
+    const ParagraphRange r = range();
+
+    // empty text between two metadata is skipped
+    if (r.end() == r.begin())
+      m_text = false;
   }
 
   return *this;
@@ -245,6 +199,12 @@ std::shared_ptr<ParagraphMetaData> ParagraphIterator::operator*() const
   return m_text ? nullptr : paragraph().metadata().at(m_index);
 }
 
+const ParagraphMetaData& ParagraphIterator::metadata() const
+{
+  assert(!m_text);
+  return *paragraph().metadata()[m_index];
+}
+
 bool ParagraphIterator::operator==(const ParagraphIterator& other) const
 {
   return m_par == other.m_par
@@ -330,6 +290,8 @@ ParagraphIterator Paragraph::end() const
 void Paragraph::setText(std::string text)
 {
   m_metadata.clear();
+  m_spans.clear();
+  m_open_spans.clear();
 
   m_text = std::move(text);
 }
@@ -353,7 +315,61 @@ void Paragraph::addMetaData(const std::shared_ptr<ParagraphMetaData>& md)
       (lhs->range().begin() == rhs->range().begin() && lhs->range().end() > rhs->range().end());
     });
 
-  m_metadata.insert(it, md);
+  // metadata are usually added in order, the spans are then updated
+  // in O(depth); otherwise they are all recomputed, like the vector
+  // insertion already costs O(n)
+  if (it != m_metadata.end())
+  {
+    m_metadata.insert(it, md);
+    updateSpans();
+    return;
+  }
+
+  const size_t index = m_metadata.size();
+  const ParagraphRange& r = md->range();
+  m_metadata.push_back(md);
+
+  // open spans that end before the new one are followed by it, the
+  // others contain it and are now followed by the end of the paragraph
+  while (!m_open_spans.empty() && m_spans[m_open_spans.back()].end < r.end())
+    m_open_spans.pop_back();
+
+  for (size_t i : m_open_spans)
+    m_spans[i].next = index + 1;
+
+  m_spans.push_back(Span{ r.begin(), r.end(), index + 1 });
+  m_open_spans.push_back(index);
+}
+
+void Paragraph::updateSpans()
+{
+  m_spans.resize(m_metadata.size());
+
+  // the 'next' of a span is the first following span that ends after it;
+  // computed right to left with a stack of candidates
+  std::vector<size_t> candidates;
+
+  for (size_t i(m_metadata.size()); i-- > 0; )
+  {
+    const ParagraphRange& r = m_metadata[i]->range();
+
+    while (!candidates.empty() && m_spans[candidates.back()].end <= r.end())
+      candidates.pop_back();
+
+    m_spans[i].begin = r.begin();
+    m_spans[i].end = r.end();
+    m_spans[i].next = candidates.empty() ? m_metadata.size() : candidates.back();
+
+    candidates.push_back(i);
+  }
+
+  m_open_spans.clear();
+
+  for (size_t i(0); i < m_spans.size(); ++i)
+  {
+    if (m_spans[i].next == m_spans.size())
+      m_open_spans.push_back(i);
+  }
 }
 
 model::Kind Link::kind() const
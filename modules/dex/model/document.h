@@ -170,6 +170,7 @@ public:
   ParagraphIterator operator++(int);
 
   std::shared_ptr<ParagraphMetaData> operator*() const;
+  const ParagraphMetaData& metadata() const;
 
   bool operator==(const ParagraphIterator& other) const;
   bool operator!=(const ParagraphIterator& other) const;
@@ -207,6 +208,20 @@ public:
 
   void addMetaData(const std::shared_ptr<ParagraphMetaData>& md);
 
+  // Flat copy of the metadata ranges, in the same order as metadata();
+  // 'next' is the index of the first metadata not nested in this one.
+  struct Span
+  {
+    size_t begin;
+    size_t end;
+    size_t next;
+  };
+
+  const std::vector<Span>& spans() const;
+
+  // must be called after a metadata range has been modified in place
+  void updateSpans();
+
   template<typename T, typename...Args>
   void add(ParagraphRange pr, Args&& ... args);
 
@@ -222,7 +237,11 @@ protected:
 
 public:
   std::string m_text;
+
+private:
   std::vector<std::shared_ptr<ParagraphMetaData>> m_metadata;
+  std::vector<Span> m_spans;
+  std::vector<size_t> m_open_spans; // spans whose 'next' is the end, outermost first
 };
 
 inline Paragraph::Paragraph(std::string text)
@@ -251,6 +270,11 @@ inline const std::vector<std::shared_ptr<ParagraphMetaData>>& Paragraph::metadat
   return m_metadata;
 }
 
+inline const std::vector<Paragraph::Span>& Paragraph::spans() const
+{
+  return m_spans;
+}
+
 template<typename T, typename...Args>
 inline void Paragraph::add(ParagraphRange pr, Args&& ... args)
 {
@@ -0,0 +1,121 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/model/frozen-program.h"
+
+#include "dex/model/program.h"
+
+namespace dex
+{
+
+static const Type* entity_type(const Entity& e)
+{
+  switch (e.kind())
+  {
+  case model::Kind::Function:
+    return &static_cast<const Function&>(e).return_type.type;
+  case model::Kind::FunctionParameter:
+    return &static_cast<const FunctionParameter&>(e).type;
+  case model::Kind::Variable:
+    return &static_cast<const Variable&>(e).type();
+  case model::Kind::Typedef:
+    return &static_cast<const Typedef&>(e).type;
+  default:
+    return nullptr;
+  }
+}
+
+template<typename T>
+static void list_children(const std::vector<std::shared_ptr<T>>& list, std::vector<Entity*>& result)
+{
+  for (const auto& e : list)
+    result.push_back(e.get());
+}
+
+static void list_children(const Entity& e, std::vector<Entity*>& result)
+{
+  switch (e.kind())
+  {
+  case model::Kind::Namespace:
+    return list_children(static_cast<const Namespace&>(e).entities, result);
+  case model::Kind::Class:
+    return list_children(static_cast<const Class&>(e).members, result);
+  case model::Kind::Enum:
+    return list_children(static_cast<const Enum&>(e).values, result);
+  case model::Kind::Function:
+    return list_children(static_cast<const Function&>(e).parameters, result);
+  default:
+    return;
+  }
+}
+
+FrozenProgram::FrozenProgram(const Program& prog)
+{
+  if (prog.globalNamespace())
+    append(*prog.globalNamespace(), npos, 0);
+
+  m_macros.first = static_cast<Index>(size());
+
+  for (size_t i(0); i < prog.macros.size(); ++i)
+    append(*prog.macros.at(i), npos, static_cast<Index>(i));
+
+  m_macros.last = static_cast<Index>(size());
+
+  std::vector<Entity*> children;
+
+  for (Index i(0); i < size(); ++i)
+  {
+    children.clear();
+    list_children(entity(i), children);
+
+    m_children[i].first = static_cast<Index>(size());
+
+    for (size_t j(0); j < children.size(); ++j)
+      append(*children.at(j), i, static_cast<Index>(j));
+
+    m_children[i].last = static_cast<Index>(size());
+  }
+}
+
+const std::string& FrozenProgram::type(Index i) const
+{
+  static const std::string static_instance = {};
+  return m_types[i] ? *m_types[i] : static_instance;
+}
+
+FrozenProgram::Index FrozenProgram::indexOf(const Entity& e) const
+{
+  auto it = m_indices.find(&e);
+  return it != m_indices.end() ? it->second : npos;
+}
+
+const std::vector<FrozenProgram::Index>& FrozenProgram::entitiesOfKind(model::Kind k) const
+{
+  static const std::vector<Index> static_instance = {};
+  const size_t n = static_cast<size_t>(k);
+  return n < m_kind_table.size() ? m_kind_table[n] : static_instance;
+}
+
+void FrozenProgram::append(Entity& e, Index parent, Index position)
+{
+  const Index index = static_cast<Index>(size());
+  const model::Kind k = e.kind();
+  const Type* t = entity_type(e);
+
+  m_kinds.push_back(k);
+  m_names.push_back(&e.name.str());
+  m_types.push_back(t ? &t->str() : nullptr);
+  m_parents.push_back(parent);
+  m_positions.push_back(position);
+  m_children.emplace_back();
+  m_entities.push_back(&e);
+  m_indices[&e] = index;
+
+  if (m_kind_table.size() <= static_cast<size_t>(k))
+    m_kind_table.resize(static_cast<size_t>(k) + 1);
+
+  m_kind_table[static_cast<size_t>(k)].push_back(index);
+}
+
+} // namespace dex
@@ -0,0 +1,123 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_MODEL_FROZENPROGRAM_H
+#define DEX_MODEL_FROZENPROGRAM_H
+
+#include "dex/dex-model.h"
+
+#include "dex/model/model-base.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dex
+{
+
+class Entity;
+class Program;
+
+// Immutable, flattened view of a Program.
+// Entities are stored breadth-first (global namespace first, then macros)
+// so that the children of an entity occupy a contiguous range of indices.
+// Names and types point to the strings interned by the entities.
+class DEX_MODEL_API FrozenProgram
+{
+public:
+  typedef uint32_t Index;
+  static constexpr Index npos = static_cast<Index>(-1);
+
+  struct Range
+  {
+    Index first = 0;
+    Index last = 0;
+
+    Index size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+public:
+  explicit FrozenProgram(const Program& prog);
+  FrozenProgram(const FrozenProgram&) = delete;
+  ~FrozenProgram() = default;
+
+  size_t size() const;
+
+  model::Kind kind(Index i) const;
+  const std::string& name(Index i) const;
+  const std::string& type(Index i) const;
+  Index parent(Index i) const;
+  Index position(Index i) const;
+  Range children(Index i) const;
+  Entity& entity(Index i) const;
+
+  Range macros() const;
+
+  Index indexOf(const Entity& e) const;
+
+  const std::vector<Index>& entitiesOfKind(model::Kind k) const;
+
+  FrozenProgram& operator=(const FrozenProgram&) = delete;
+
+protected:
+  void append(Entity& e, Index parent, Index position);
+
+private:
+  std::vector<model::Kind> m_kinds;
+  std::vector<const std::string*> m_names;
+  std::vector<const std::string*> m_types; // nullptr if the entity has no type
+  std::vector<Index> m_parents;
+  std::vector<Index> m_positions;
+  std::vector<Range> m_children;
+  std::vector<Entity*> m_entities;
+  std::vector<std::vector<Index>> m_kind_table;
+  std::unordered_map<const Entity*, Index> m_indices;
+  Range m_macros;
+};
+
+inline size_t FrozenProgram::size() const
+{
+  return m_entities.size();
+}
+
+inline model::Kind FrozenProgram::kind(Index i) const
+{
+  return m_kinds[i];
+}
+
+inline const std::string& FrozenProgram::name(Index i) const
+{
+  return *m_names[i];
+}
+
+inline FrozenProgram::Index FrozenProgram::parent(Index i) const
+{
+  return m_parents[i];
+}
+
+inline FrozenProgram::Index FrozenProgram::position(Index i) const
+{
+  return m_positions[i];
+}
+
+inline FrozenProgram::Range FrozenProgram::children(Index i) const
+{
+  return m_children[i];
+}
+
+inline Entity& FrozenProgram::entity(Index i) const
+{
+  return *m_entities[i];
+}
+
+inline FrozenProgram::Range FrozenProgram::macros() const
+{
+  return m_macros;
+}
+
+} // namespace dex
+
+#endif // DEX_MODEL_FROZENPROGRAM_H
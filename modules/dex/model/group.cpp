@@ -4,12 +4,18 @@
 
 #include "dex/model/group.h"
 
+#include "dex/model/document.h"
+#include "dex/model/program.h"
+
+#include <algorithm>
+
 namespace dex
 {
 
 std::shared_ptr<Group> GroupManager::get(const std::string& name) const
 {
-  return name_map.at(name);
+  auto it = name_map.find(name);
+  return it != name_map.end() ? it->second : nullptr;
 }
 
 std::shared_ptr<Group> GroupManager::getOrCreate(const std::string& name)
@@ -25,6 +31,42 @@ std::shared_ptr<Group> GroupManager::getOrCreate(const std::string& name)
   return g;
 }
 
+bool GroupManager::insert(const std::shared_ptr<Group>& g, std::shared_ptr<dex::Entity> e)
+{
+  if (!addMembership(g, *e))
+    return false;
+
+  g->insert(e);
+  return true;
+}
+
+bool GroupManager::insert(const std::shared_ptr<Group>& g, std::shared_ptr<dex::Document> doc)
+{
+  if (!addMembership(g, *doc))
+    return false;
+
+  g->insert(doc);
+  return true;
+}
+
+const std::vector<std::shared_ptr<Group>>& GroupManager::groupsOf(const model::Object& obj) const
+{
+  static const std::vector<std::shared_ptr<Group>> static_empty_list = {};
+  auto it = m_memberships.find(&obj);
+  return it != m_memberships.end() ? it->second : static_empty_list;
+}
+
+bool GroupManager::addMembership(const std::shared_ptr<Group>& g, const model::Object& obj)
+{
+  std::vector<std::shared_ptr<Group>>& list = m_memberships[&obj];
+
+  if (std::find(list.begin(), list.end(), g) != list.end())
+    return false;
+
+  list.push_back(g);
+  return true;
+}
+
 Group::Group(size_t i, std::string n)
   : index(i),
     name(std::move(n))
@@ -26,13 +26,25 @@ class DEX_MODEL_API GroupManager
 {
 public:
   std::vector<std::shared_ptr<Group>> groups;
-  std::map<std::string, std::shared_ptr<Group>> name_map;
+  std::unordered_map<std::string, std::shared_ptr<Group>> name_map;
 
   std::shared_ptr<Group> get(const std::string& name) const;
   std::shared_ptr<Group> getOrCreate(const std::string& name);
 
+  bool insert(const std::shared_ptr<Group>& g, std::shared_ptr<dex::Entity> e);
+  bool insert(const std::shared_ptr<Group>& g, std::shared_ptr<dex::Document> doc);
+
   template<typename T>
   void multiInsert(const std::vector<std::string>& groupnames, T elem);
+
+  // groups containing an entity or a document, in insertion order
+  const std::vector<std::shared_ptr<Group>>& groupsOf(const model::Object& obj) const;
+
+private:
+  bool addMembership(const std::shared_ptr<Group>& g, const model::Object& obj);
+
+private:
+  std::unordered_map<const model::Object*, std::vector<std::shared_ptr<Group>>> m_memberships;
 };
 
 class DEX_MODEL_API Group : public model::Object
@@ -49,14 +61,17 @@ public:
 
   Content content;
 
-  void insert(std::shared_ptr<dex::Entity> e);
-  void insert(std::shared_ptr<dex::Document> doc);
-
 public:
   Group(size_t index, std::string n);
 
   static constexpr model::Kind ClassKind = model::Kind::Group;
   model::Kind kind() const override;
+
+protected:
+  // elements are added through GroupManager, which indexes memberships
+  friend class GroupManager;
+  void insert(std::shared_ptr<dex::Entity> e);
+  void insert(std::shared_ptr<dex::Document> doc);
 };
 
 template<typename T>
@@ -64,8 +79,7 @@ inline void GroupManager::multiInsert(const std::vector<std::string>& groupnames
 {
   for (const auto& gname : groupnames)
   {
-    std::shared_ptr<Group> g = getOrCreate(gname);
-    g->insert(elem);
+    insert(getOrCreate(gname), elem);
   }
 }
 
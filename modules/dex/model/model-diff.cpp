@@ -0,0 +1,437 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/model/model-diff.h"
+
+#include "dex/model/code-block.h"
+#include "dex/model/display-math.h"
+#include "dex/model/model.h"
+#include "dex/model/model-visitor.h"
+#include "dex/model/paragraph-annotations.h"
+
+namespace dex
+{
+
+namespace model
+{
+
+// 64-bit FNV-1a
+class Hasher
+{
+public:
+  uint64_t value = 14695981039346656037ull;
+
+  void feed(const void* data, size_t size)
+  {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+
+    for (size_t i(0); i < size; ++i)
+    {
+      value ^= bytes[i];
+      value *= 1099511628211ull;
+    }
+  }
+
+  void feed(uint64_t n)
+  {
+    feed(&n, sizeof(n));
+  }
+
+  void feed(const std::string& str)
+  {
+    feed(str.size());
+    feed(str.data(), str.size());
+  }
+
+  void feed(const InternedString& str)
+  {
+    feed(str.str());
+  }
+
+  void feed(const std::optional<std::string>& str)
+  {
+    feed(str.has_value() ? 1 : 0);
+
+    if (str.has_value())
+      feed(*str);
+  }
+};
+
+class DocumentHasher : public DocumentVisitor
+{
+public:
+  Hasher& hasher;
+
+public:
+  explicit DocumentHasher(Hasher& h)
+    : hasher(h)
+  {
+
+  }
+
+  void visitNode(dex::DocumentNode& n) override
+  {
+    hasher.feed(static_cast<uint64_t>(n.kind()));
+    hasher.feed(n.childNodes().size());
+
+    if (n.isDocumentElement())
+      hasher.feed(static_cast<dex::DocumentElement&>(n).id);
+
+    DocumentVisitor::visitNode(n);
+  }
+
+protected:
+  void visit(dex::Image& img) override
+  {
+    hasher.feed(img.src);
+    hasher.feed(static_cast<uint64_t>(img.width));
+    hasher.feed(static_cast<uint64_t>(img.height));
+  }
+
+  void visit(dex::List& l) override
+  {
+    hasher.feed(l.marker);
+    hasher.feed(l.ordered);
+    hasher.feed(l.reversed);
+  }
+
+  void visit(dex::ListItem& li) override
+  {
+    hasher.feed(li.marker);
+    hasher.feed(static_cast<uint64_t>(li.value));
+  }
+
+  void visit(dex::Paragraph& par) override
+  {
+    hasher.feed(par.text());
+    hasher.feed(par.metadata().size());
+
+    for (const auto& md : par.metadata())
+    {
+      hasher.feed(static_cast<uint64_t>(md->kind()));
+      hasher.feed(md->range().begin());
+      hasher.feed(md->range().end());
+
+      if (md->is<dex::Link>())
+        hasher.feed(static_cast<const dex::Link&>(*md).url());
+      else if (md->is<dex::TextStyle>())
+        hasher.feed(static_cast<const dex::TextStyle&>(*md).style());
+      else if (md->is<dex::Since>())
+        hasher.feed(md->get<dex::Since>().version());
+      else if (md->is<dex::ParIndexEntry>())
+        hasher.feed(md->get<dex::ParIndexEntry>().key);
+    }
+  }
+
+  void visit(dex::BeginSince& bsince) override
+  {
+    hasher.feed(bsince.version);
+  }
+
+  void visit(dex::DisplayMath& math) override
+  {
+    hasher.feed(math.source);
+  }
+
+  void visit(dex::GroupTable& table) override
+  {
+    hasher.feed(table.groupname);
+  }
+
+  void visit(dex::CodeBlock& codeblock) override
+  {
+    hasher.feed(codeblock.lang);
+    hasher.feed(codeblock.code);
+  }
+
+  void visit(dex::Sectioning& section) override
+  {
+    hasher.feed(static_cast<uint64_t>(section.depth));
+    hasher.feed(section.name);
+  }
+};
+
+static void hash_document(Hasher& hasher, const Document& doc)
+{
+  hasher.feed(doc.doctype);
+  hasher.feed(doc.title);
+  hasher.feed(doc.nodes.size());
+
+  DocumentHasher visitor{ hasher };
+  visitor.visitDocument(doc);
+}
+
+static void hash_entity_base(Hasher& hasher, const Entity& e)
+{
+  hasher.feed(static_cast<uint64_t>(e.kind()));
+  hasher.feed(e.name);
+  hasher.feed(e.brief);
+  hasher.feed(e.since.has_value() ? std::optional<std::string>(e.since->version()) : std::nullopt);
+  hasher.feed(e.description != nullptr);
+
+  if (e.description)
+    hash_document(hasher, *e.description);
+}
+
+static void hash_template_parameters(Hasher& hasher, const std::vector<std::shared_ptr<TemplateParameter>>& tparams)
+{
+  hasher.feed(tparams.size());
+
+  for (const auto& tp : tparams)
+  {
+    hash_entity_base(hasher, *tp);
+    hasher.feed(tp->isTypeParameter());
+
+    if (tp->isTypeParameter())
+    {
+      hasher.feed(tp->get<TemplateTypeParameter>().default_value);
+    }
+    else
+    {
+      hasher.feed(tp->get<TemplateNonTypeParameter>().type);
+      hasher.feed(tp->get<TemplateNonTypeParameter>().default_value);
+    }
+  }
+}
+
+static uint64_t hash_entity(const Entity& e, const Program& prog)
+{
+  Hasher hasher;
+  hash_entity_base(hasher, e);
+
+  switch (e.kind())
+  {
+  case Kind::Class:
+  {
+    const auto& c = static_cast<const Class&>(e);
+    hasher.feed(static_cast<uint64_t>(c.access_specifier));
+    hasher.feed(c.is_struct);
+    hasher.feed(c.is_final);
+    hasher.feed(c.bases.size());
+
+    for (const BaseClass& b : c.bases)
+    {
+      hasher.feed(static_cast<uint64_t>(b.access_specifier));
+      hasher.feed(b.base ? path(*b.base) : std::string());
+    }
+
+    hash_template_parameters(hasher, c.template_parameters);
+  }
+  break;
+  case Kind::Enum:
+  {
+    const auto& en = static_cast<const Enum&>(e);
+    hasher.feed(static_cast<uint64_t>(en.access_specifier));
+    hasher.feed(en.enum_class);
+    hasher.feed(en.values.size());
+
+    for (const auto& v : en.values)
+    {
+      hash_entity_base(hasher, *v);
+      hasher.feed(v->value());
+    }
+  }
+  break;
+  case Kind::Function:
+  {
+    const auto& f = static_cast<const Function&>(e);
+    hasher.feed(static_cast<uint64_t>(f.access_specifier));
+    hasher.feed(f.return_type.type);
+    hasher.feed(f.return_type.brief);
+    hasher.feed(static_cast<uint64_t>(f.specifiers));
+    hasher.feed(static_cast<uint64_t>(f.category));
+    hasher.feed(f.parameters.size());
+
+    for (const auto& p : f.parameters)
+    {
+      hash_entity_base(hasher, *p);
+      hasher.feed(p->type);
+      hasher.feed(p->default_value);
+    }
+
+    hash_template_parameters(hasher, f.template_parameters);
+
+    // a related non-member is part of its class documentation
+    auto self = std::static_pointer_cast<Function>(std::const_pointer_cast<Entity>(e.shared_from_this()));
+    auto related = prog.related.functions_map.find(self);
+    hasher.feed(related != prog.related.functions_map.end() ? path(*related->second->the_class) : std::string());
+  }
+  break;
+  case Kind::Variable:
+  {
+    const auto& v = static_cast<const Variable&>(e);
+    hasher.feed(v.type());
+    hasher.feed(static_cast<uint64_t>(v.specifiers()));
+    hasher.feed(v.defaultValue());
+  }
+  break;
+  case Kind::Typedef:
+  {
+    const auto& t = static_cast<const Typedef&>(e);
+    hasher.feed(static_cast<uint64_t>(t.access_specifier));
+    hasher.feed(t.type);
+  }
+  break;
+  case Kind::Macro:
+  {
+    const auto& m = static_cast<const Macro&>(e);
+    hasher.feed(m.parameters.size());
+
+    for (const std::string& p : m.parameters)
+      hasher.feed(p);
+  }
+  break;
+  default:
+    break;
+  }
+
+  return hasher.value;
+}
+
+static void insert_hash(std::map<std::string, uint64_t>& map, std::string key, uint64_t h)
+{
+  auto it = map.find(key);
+
+  if (it == map.end())
+  {
+    map.emplace(std::move(key), h);
+  }
+  else
+  {
+    Hasher hasher;
+    hasher.feed(it->second);
+    hasher.feed(h);
+    it->second = hasher.value;
+  }
+}
+
+static void hash_entities(ModelHashes& result, const Entity& e, const Program& prog)
+{
+  insert_hash(result.entities, path(e), hash_entity(e, prog));
+
+  if (e.is<Namespace>())
+  {
+    for (const auto& child : static_cast<const Namespace&>(e).entities)
+      hash_entities(result, *child, prog);
+  }
+  else if (e.is<Class>())
+  {
+    for (const auto& child : static_cast<const Class&>(e).members)
+      hash_entities(result, *child, prog);
+  }
+}
+
+uint64_t hash(const std::string& data)
+{
+  Hasher h;
+  h.feed(data.data(), data.size());
+  return h.value;
+}
+
+ModelHashes hash(const Model& model)
+{
+  ModelHashes result;
+
+  if (std::shared_ptr<Program> prog = model.program())
+  {
+    hash_entities(result, *prog->globalNamespace(), *prog);
+
+    for (const auto& m : prog->macros)
+      hash_entities(result, *m, *prog);
+  }
+
+  for (const auto& doc : model.documents)
+  {
+    Hasher hasher;
+    hash_document(hasher, *doc);
+    insert_hash(result.documents, path(*doc), hasher.value);
+  }
+
+  for (const auto& g : model.groups.groups)
+  {
+    Hasher hasher;
+
+    for (const auto& e : g->content.entities)
+      hasher.feed(path(*e));
+
+    for (const auto& d : g->content.documents)
+      hasher.feed(path(*d));
+
+    insert_hash(result.groups, g->name, hasher.value);
+  }
+
+  return result;
+}
+
+std::string path(const Entity& e)
+{
+  if (e.is<Macro>())
+    return "#" + e.name;
+
+  std::string result = e.is<Function>() ? static_cast<const Function&>(e).signature() : e.name.str();
+
+  for (auto p = e.parent(); p != nullptr; p = p->parent())
+  {
+    if (!p->name.empty())
+      result = p->name + "::" + result;
+  }
+
+  return result.empty() ? "::" : result;
+}
+
+std::string path(const Document& doc)
+{
+  return doc.doctype + "/" + doc.title;
+}
+
+bool ModelDiff::empty() const
+{
+  return entities.empty() && documents.empty() && groups.empty();
+}
+
+static void diff_maps(const std::map<std::string, uint64_t>& before, const std::map<std::string, uint64_t>& after, std::vector<ModelDiff::Entry>& result)
+{
+  auto it = before.begin();
+  auto jt = after.begin();
+
+  while (it != before.end() || jt != after.end())
+  {
+    if (jt == after.end() || (it != before.end() && it->first < jt->first))
+    {
+      result.push_back({ it->first, ModelDiff::Removed });
+      ++it;
+    }
+    else if (it == before.end() || jt->first < it->first)
+    {
+      result.push_back({ jt->first, ModelDiff::Added });
+      ++jt;
+    }
+    else
+    {
+      if (it->second != jt->second)
+        result.push_back({ it->first, ModelDiff::Changed });
+
+      ++it;
+      ++jt;
+    }
+  }
+}
+
+ModelDiff diff(const ModelHashes& before, const ModelHashes& after)
+{
+  ModelDiff result;
+  diff_maps(before.entities, after.entities, result.entities);
+  diff_maps(before.documents, after.documents, result.documents);
+  diff_maps(before.groups, after.groups, result.groups);
+  return result;
+}
+
+ModelDiff diff(const Model& before, const Model& after)
+{
+  return diff(hash(before), hash(after));
+}
+
+} // namespace model
+
+} // namespace dex
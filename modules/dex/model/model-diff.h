@@ -0,0 +1,77 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_MODEL_MODELDIFF_H
+#define DEX_MODEL_MODELDIFF_H
+
+#include "dex/dex-model.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+class Document;
+class Entity;
+class Model;
+
+namespace model
+{
+
+// Content hashes of the entities, documents and groups of a model,
+// indexed by path.
+// An entity hash covers the entity, its description and the entities it
+// owns that do not have a path (parameters, enum values), but not its
+// members; objects sharing a path have their hashes combined.
+struct DEX_MODEL_API ModelHashes
+{
+  std::map<std::string, uint64_t> entities;
+  std::map<std::string, uint64_t> documents;
+  std::map<std::string, uint64_t> groups;
+};
+
+DEX_MODEL_API ModelHashes hash(const Model& model);
+
+// 64-bit FNV-1a hash of a string, stable across runs and platforms.
+DEX_MODEL_API uint64_t hash(const std::string& data);
+
+// Paths used to identify objects across models: qualified name for
+// entities, with the signature for functions; doctype and title for
+// documents.
+DEX_MODEL_API std::string path(const Entity& e);
+DEX_MODEL_API std::string path(const Document& doc);
+
+struct DEX_MODEL_API ModelDiff
+{
+  enum Status
+  {
+    Added,
+    Removed,
+    Changed,
+  };
+
+  struct Entry
+  {
+    std::string path;
+    Status status;
+  };
+
+  std::vector<Entry> entities;
+  std::vector<Entry> documents;
+  std::vector<Entry> groups;
+
+  bool empty() const;
+};
+
+DEX_MODEL_API ModelDiff diff(const ModelHashes& before, const ModelHashes& after);
+DEX_MODEL_API ModelDiff diff(const Model& before, const Model& after);
+
+} // namespace model
+
+} // namespace dex
+
+#endif // DEX_MODEL_MODELDIFF_H
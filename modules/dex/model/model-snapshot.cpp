@@ -0,0 +1,1116 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/model/model-snapshot.h"
+
+#include "dex/model/code-block.h"
+#include "dex/model/display-math.h"
+#include "dex/model/inline-math.h"
+#include "dex/model/model.h"
+#include "dex/model/paragraph-annotations.h"
+
+#include "dex/common/errors.h"
+#include "dex/common/file-utils.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace dex
+{
+
+namespace snapshot
+{
+
+// Layout: magic, version, string table, then the body.
+// Integers are LEB128 varints; strings are indices in the string table;
+// references to entities, documents and BeginSince nodes are 1-based ids
+// given in the order in which these are written (0 is null).
+static const char magic[8] = { 'D', 'E', 'X', 'M', 'O', 'D', 'E', 'L' };
+
+class Writer
+{
+public:
+  void writeModel(const Model& model);
+  void flush(std::ostream& out);
+
+protected:
+  void writeUInt(uint64_t n);
+  void writeUInt(uint64_t n, std::string& buffer);
+  void writeBool(bool b);
+  void writeString(const std::string& str);
+  void writeOptional(const std::optional<std::string>& str);
+  void writeRef(const std::unordered_map<const void*, size_t>& ids, const void* ptr);
+
+  void writeEntity(const Entity& e);
+  void writeEntities(const std::vector<std::shared_ptr<Entity>>& list);
+  void writeTemplateParameters(const std::vector<std::shared_ptr<TemplateParameter>>& tparams);
+  void writeDocument(const Document& doc);
+  void writeNodes(const DomNodeList& nodes);
+  void writeNode(const DocumentNode& node);
+  void writeParagraph(const Paragraph& par);
+
+private:
+  std::string m_body;
+  std::unordered_map<std::string, size_t> m_string_ids;
+  std::vector<const std::string*> m_strings;
+  std::unordered_map<const void*, size_t> m_entity_ids;
+  std::unordered_map<const void*, size_t> m_document_ids;
+  std::unordered_map<const void*, size_t> m_beginsince_ids;
+  std::vector<const Class*> m_derived_classes;
+};
+
+void Writer::writeUInt(uint64_t n)
+{
+  writeUInt(n, m_body);
+}
+
+void Writer::writeUInt(uint64_t n, std::string& buffer)
+{
+  while (n >= 0x80)
+  {
+    buffer.push_back(static_cast<char>((n & 0x7F) | 0x80));
+    n >>= 7;
+  }
+
+  buffer.push_back(static_cast<char>(n));
+}
+
+void Writer::writeBool(bool b)
+{
+  m_body.push_back(b ? 1 : 0);
+}
+
+void Writer::writeString(const std::string& str)
+{
+  auto it = m_string_ids.find(str);
+
+  if (it == m_string_ids.end())
+  {
+    it = m_string_ids.emplace(str, m_strings.size()).first;
+    m_strings.push_back(&it->first);
+  }
+
+  writeUInt(it->second);
+}
+
+void Writer::writeOptional(const std::optional<std::string>& str)
+{
+  writeBool(str.has_value());
+
+  if (str.has_value())
+    writeString(*str);
+}
+
+void Writer::writeRef(const std::unordered_map<const void*, size_t>& ids, const void* ptr)
+{
+  auto it = ids.find(ptr);
+  writeUInt(it != ids.end() ? it->second : 0);
+}
+
+void Writer::writeModel(const Model& model)
+{
+  std::shared_ptr<Program> prog = model.program();
+
+  writeBool(prog != nullptr);
+
+  if (prog)
+  {
+    writeEntity(*prog->globalNamespace());
+
+    writeUInt(prog->macros.size());
+
+    for (const auto& m : prog->macros)
+      writeEntity(*m);
+
+    // base classes may be declared after their derived classes, so they
+    // are written once all entities have an id
+    writeUInt(m_derived_classes.size());
+
+    for (const Class* c : m_derived_classes)
+    {
+      writeRef(m_entity_ids, c);
+      writeUInt(c->bases.size());
+
+      for (const BaseClass& b : c->bases)
+      {
+        writeUInt(static_cast<uint64_t>(b.access_specifier));
+        writeRef(m_entity_ids, b.base.get());
+      }
+    }
+  }
+
+  writeUInt(model.documents.size());
+
+  for (const auto& doc : model.documents)
+    writeDocument(*doc);
+
+  if (prog)
+  {
+    // sorted by class so that the output does not depend on hashing
+    std::map<size_t, const RelatedNonMembers::Entry*> related;
+
+    for (const auto& entry : prog->related.class_map)
+    {
+      auto it = m_entity_ids.find(entry.first.get());
+
+      if (it != m_entity_ids.end())
+        related[it->second] = entry.second.get();
+    }
+
+    writeUInt(related.size());
+
+    for (const auto& entry : related)
+    {
+      writeUInt(entry.first);
+      writeUInt(entry.second->non_members.size());
+
+      for (const auto& f : entry.second->non_members)
+        writeRef(m_entity_ids, f.get());
+    }
+  }
+
+  writeUInt(model.groups.groups.size());
+
+  for (const auto& g : model.groups.groups)
+  {
+    writeString(g->name);
+
+    writeUInt(g->content.entities.size());
+
+    for (const auto& e : g->content.entities)
+      writeRef(m_entity_ids, e.get());
+
+    writeUInt(g->content.documents.size());
+
+    for (const auto& d : g->content.documents)
+      writeRef(m_document_ids, d.get());
+  }
+}
+
+void Writer::flush(std::ostream& out)
+{
+  std::string header(magic, sizeof(magic));
+  writeUInt(version, header);
+  writeUInt(m_strings.size(), header);
+
+  for (const std::string* str : m_strings)
+  {
+    writeUInt(str->size(), header);
+    header += *str;
+  }
+
+  out.write(header.data(), header.size());
+  out.write(m_body.data(), m_body.size());
+}
+
+void Writer::writeEntity(const Entity& e)
+{
+  const size_t id = m_entity_ids.size() + 1;
+  m_entity_ids[&e] = id;
+
+  writeUInt(static_cast<uint64_t>(e.kind()));
+  writeString(e.name);
+  writeOptional(e.brief);
+  writeBool(e.since.has_value());
+
+  if (e.since.has_value())
+    writeString(e.since->version());
+
+  writeBool(e.description != nullptr);
+
+  if (e.description)
+    writeDocument(*e.description);
+
+  switch (e.kind())
+  {
+  case model::Kind::Namespace:
+  {
+    writeEntities(static_cast<const Namespace&>(e).entities);
+  }
+  break;
+  case model::Kind::Class:
+  {
+    const auto& c = static_cast<const Class&>(e);
+    writeUInt(static_cast<uint64_t>(c.access_specifier));
+    writeBool(c.is_struct);
+    writeBool(c.is_final);
+    writeTemplateParameters(c.template_parameters);
+    writeEntities(c.members);
+
+    if (!c.bases.empty())
+      m_derived_classes.push_back(&c);
+  }
+  break;
+  case model::Kind::Enum:
+  {
+    const auto& en = static_cast<const Enum&>(e);
+    writeUInt(static_cast<uint64_t>(en.access_specifier));
+    writeBool(en.enum_class);
+    writeUInt(en.values.size());
+
+    for (const auto& v : en.values)
+      writeEntity(*v);
+  }
+  break;
+  case model::Kind::EnumValue:
+  {
+    writeString(static_cast<const EnumValue&>(e).value());
+  }
+  break;
+  case model::Kind::Function:
+  {
+    const auto& f = static_cast<const Function&>(e);
+    writeUInt(static_cast<uint64_t>(f.access_specifier));
+    writeString(f.return_type.type);
+    writeOptional(f.return_type.brief);
+    writeUInt(f.specifiers);
+    writeUInt(f.category);
+    writeTemplateParameters(f.template_parameters);
+    writeUInt(f.parameters.size());
+
+    for (const auto& p : f.parameters)
+      writeEntity(*p);
+  }
+  break;
+  case model::Kind::FunctionParameter:
+  {
+    const auto& p = static_cast<const FunctionParameter&>(e);
+    writeString(p.type);
+    writeString(p.default_value);
+  }
+  break;
+  case model::Kind::TemplateParameter:
+  {
+    const auto& tp = static_cast<const TemplateParameter&>(e);
+    writeBool(tp.isTypeParameter());
+
+    if (tp.isTypeParameter())
+    {
+      writeString(tp.get<TemplateTypeParameter>().default_value);
+    }
+    else
+    {
+      writeString(tp.get<TemplateNonTypeParameter>().type);
+      writeString(tp.get<TemplateNonTypeParameter>().default_value);
+    }
+  }
+  break;
+  case model::Kind::Variable:
+  {
+    const auto& v = static_cast<const Variable&>(e);
+    writeString(v.type());
+    writeUInt(v.specifiers());
+    writeString(v.defaultValue());
+  }
+  break;
+  case model::Kind::Typedef:
+  {
+    const auto& t = static_cast<const Typedef&>(e);
+    writeUInt(static_cast<uint64_t>(t.access_specifier));
+    writeString(t.type);
+  }
+  break;
+  case model::Kind::Macro:
+  {
+    const auto& m = static_cast<const Macro&>(e);
+    writeUInt(m.parameters.size());
+
+    for (const std::string& p : m.parameters)
+      writeString(p);
+  }
+  break;
+  default:
+    throw std::runtime_error{ "snapshot: unsupported entity " + model::to_string(e.kind()) };
+  }
+}
+
+void Writer::writeEntities(const std::vector<std::shared_ptr<Entity>>& list)
+{
+  writeUInt(list.size());
+
+  for (const auto& e : list)
+    writeEntity(*e);
+}
+
+void Writer::writeTemplateParameters(const std::vector<std::shared_ptr<TemplateParameter>>& tparams)
+{
+  writeUInt(tparams.size());
+
+  for (const auto& tp : tparams)
+    writeEntity(*tp);
+}
+
+void Writer::writeDocument(const Document& doc)
+{
+  const size_t id = m_document_ids.size() + 1;
+  m_document_ids[&doc] = id;
+
+  writeString(doc.doctype);
+  writeString(doc.title);
+  writeNodes(doc.nodes);
+}
+
+void Writer::writeNodes(const DomNodeList& nodes)
+{
+  writeUInt(nodes.size());
+
+  for (const auto& n : nodes)
+    writeNode(*n);
+}
+
+void Writer::writeNode(const DocumentNode& node)
+{
+  writeUInt(static_cast<uint64_t>(node.kind()));
+
+  if (node.isDocumentElement())
+    writeString(static_cast<const DocumentElement&>(node).id);
+
+  switch (node.kind())
+  {
+  case model::Kind::Paragraph:
+    writeParagraph(static_cast<const Paragraph&>(node));
+    break;
+  case model::Kind::Sectioning:
+  {
+    const auto& sec = static_cast<const Sectioning&>(node);
+    writeUInt(static_cast<uint64_t>(sec.depth + 1));
+    writeString(sec.name);
+    writeNodes(sec.content);
+  }
+  break;
+  case model::Kind::List:
+  {
+    const auto& l = static_cast<const List&>(node);
+    writeString(l.marker);
+    writeBool(l.ordered);
+    writeBool(l.reversed);
+    writeNodes(l.items);
+  }
+  break;
+  case model::Kind::ListItem:
+  {
+    const auto& li = static_cast<const ListItem&>(node);
+    writeString(li.marker);
+    writeUInt(static_cast<uint64_t>(li.value + 1));
+    writeNodes(li.content);
+  }
+  break;
+  case model::Kind::Image:
+  {
+    const auto& img = static_cast<const Image&>(node);
+    writeString(img.src);
+    writeUInt(static_cast<uint64_t>(img.width + 1));
+    writeUInt(static_cast<uint64_t>(img.height + 1));
+  }
+  break;
+  case model::Kind::CodeBlock:
+  {
+    const auto& cb = static_cast<const CodeBlock&>(node);
+    writeString(cb.lang);
+    writeString(cb.code);
+  }
+  break;
+  case model::Kind::DisplayMath:
+    writeString(static_cast<const DisplayMath&>(node).source);
+    break;
+  case model::Kind::GroupTable:
+    writeString(static_cast<const GroupTable&>(node).groupname);
+    break;
+  case model::Kind::BeginSince:
+  {
+    const size_t id = m_beginsince_ids.size() + 1;
+    m_beginsince_ids[&node] = id;
+    writeString(static_cast<const BeginSince&>(node).version);
+  }
+  break;
+  case model::Kind::EndSince:
+    writeRef(m_beginsince_ids, static_cast<const EndSince&>(node).beginsince.lock().get());
+    break;
+  case model::Kind::FrontMatter:
+  case model::Kind::MainMatter:
+  case model::Kind::BackMatter:
+  case model::Kind::TableOfContents:
+  case model::Kind::Index:
+    break;
+  default:
+    throw std::runtime_error{ "snapshot: unsupported document node " + model::to_string(node.kind()) };
+  }
+}
+
+void Writer::writeParagraph(const Paragraph& par)
+{
+  writeString(par.text());
+  writeUInt(par.metadata().size());
+
+  for (const auto& md : par.metadata())
+  {
+    writeUInt(static_cast<uint64_t>(md->kind()));
+    writeUInt(md->range().begin());
+    writeUInt(md->range().end());
+
+    switch (md->kind())
+    {
+    case model::Kind::Link:
+      writeString(static_cast<const Link&>(*md).url());
+      break;
+    case model::Kind::TextStyle:
+      writeString(static_cast<const TextStyle&>(*md).style());
+      break;
+    case model::Kind::Since:
+      writeString(md->get<Since>().version());
+      break;
+    case model::Kind::IndexEntry:
+      writeString(md->get<ParIndexEntry>().key);
+      break;
+    case model::Kind::InlineMath:
+      break;
+    default:
+      throw std::runtime_error{ "snapshot: unsupported paragraph metadata " + model::to_string(md->kind()) };
+    }
+  }
+}
+
+class Reader
+{
+public:
+  Reader(const char* data, size_t size);
+
+  std::shared_ptr<Model> readModel();
+
+protected:
+  [[noreturn]] void corrupted() const;
+
+  uint64_t readUInt();
+  bool readBool();
+  model::Kind readKind();
+  std::string_view readView();
+  std::string readString();
+  std::optional<std::string> readOptional();
+
+  template<typename T>
+  std::shared_ptr<T> readEntity(const std::shared_ptr<Entity>& parent);
+  std::shared_ptr<Entity> readEntity(const std::shared_ptr<Entity>& parent);
+  void readEntities(std::vector<std::shared_ptr<Entity>>& list, const std::shared_ptr<Entity>& parent);
+  void readTemplateParameters(std::vector<std::shared_ptr<TemplateParameter>>& tparams);
+  std::shared_ptr<Document> readDocument();
+  void readNodes(DocumentNode& parent);
+  std::shared_ptr<DocumentNode> readNode();
+  void readParagraph(Paragraph& par);
+
+  template<typename T>
+  std::shared_ptr<T> get(const std::vector<std::shared_ptr<T>>& list);
+
+private:
+  const char* m_pos;
+  const char* m_end;
+  std::vector<std::string_view> m_strings;
+  std::vector<std::shared_ptr<Entity>> m_entities;
+  std::vector<std::shared_ptr<Document>> m_documents;
+  std::vector<std::shared_ptr<BeginSince>> m_beginsinces;
+};
+
+Reader::Reader(const char* data, size_t size)
+  : m_pos(data),
+    m_end(data + size)
+{
+  if (size < sizeof(magic) || std::memcmp(data, magic, sizeof(magic)) != 0)
+    throw std::runtime_error{ "snapshot: not a dex model snapshot" };
+
+  m_pos += sizeof(magic);
+
+  if (readUInt() != version)
+    throw std::runtime_error{ "snapshot: unsupported version" };
+
+  const size_t nstrings = static_cast<size_t>(readUInt());
+
+  if (nstrings > static_cast<size_t>(m_end - m_pos))
+    corrupted();
+
+  m_strings.reserve(nstrings);
+
+  for (size_t i(0); i < nstrings; ++i)
+  {
+    const size_t len = static_cast<size_t>(readUInt());
+
+    if (len > static_cast<size_t>(m_end - m_pos))
+      corrupted();
+
+    m_strings.emplace_back(m_pos, len);
+    m_pos += len;
+  }
+}
+
+void Reader::corrupted() const
+{
+  throw std::runtime_error{ "snapshot: truncated or corrupted data" };
+}
+
+uint64_t Reader::readUInt()
+{
+  uint64_t result = 0;
+
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    if (m_pos == m_end)
+      corrupted();
+
+    const auto byte = static_cast<unsigned char>(*m_pos++);
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+    if (!(byte & 0x80))
+      return result;
+  }
+
+  corrupted();
+}
+
+bool Reader::readBool()
+{
+  if (m_pos == m_end)
+    corrupted();
+
+  return *m_pos++ != 0;
+}
+
+model::Kind Reader::readKind()
+{
+  const uint64_t k = readUInt();
+
+  if (k > static_cast<uint64_t>(model::Kind::Macro))
+    corrupted();
+
+  return static_cast<model::Kind>(k);
+}
+
+std::string_view Reader::readView()
+{
+  const uint64_t index = readUInt();
+
+  if (index >= m_strings.size())
+    corrupted();
+
+  return m_strings[static_cast<size_t>(index)];
+}
+
+std::string Reader::readString()
+{
+  return std::string(readView());
+}
+
+std::optional<std::string> Reader::readOptional()
+{
+  if (readBool())
+    return readString();
+  else
+    return std::nullopt;
+}
+
+template<typename T>
+std::shared_ptr<T> Reader::get(const std::vector<std::shared_ptr<T>>& list)
+{
+  const uint64_t id = readUInt();
+
+  if (id > list.size())
+    corrupted();
+
+  return id == 0 ? nullptr : list[static_cast<size_t>(id - 1)];
+}
+
+template<typename T>
+std::shared_ptr<T> Reader::readEntity(const std::shared_ptr<Entity>& parent)
+{
+  std::shared_ptr<Entity> e = readEntity(parent);
+
+  if (!e->is<T>())
+    corrupted();
+
+  return std::static_pointer_cast<T>(e);
+}
+
+static std::shared_ptr<Entity> create_entity(model::Kind k, std::string name, const std::shared_ptr<Entity>& parent)
+{
+  switch (k)
+  {
+  case model::Kind::Namespace:
+    return std::make_shared<Namespace>(std::move(name), parent);
+  case model::Kind::Class:
+    return std::make_shared<Class>(std::move(name), parent);
+  case model::Kind::Enum:
+    return std::make_shared<Enum>(std::move(name), parent);
+  case model::Kind::EnumValue:
+    if (!parent || !parent->is<Enum>())
+      return nullptr;
+    return std::make_shared<EnumValue>(std::move(name), std::static_pointer_cast<Enum>(parent));
+  case model::Kind::Function:
+    return std::make_shared<Function>(std::move(name), parent);
+  case model::Kind::FunctionParameter:
+    if (!parent || !parent->is<Function>())
+      return nullptr;
+    return std::make_shared<FunctionParameter>(Type(), std::move(name), std::static_pointer_cast<Function>(parent));
+  case model::Kind::TemplateParameter:
+    return std::make_shared<TemplateParameter>(std::move(name), TemplateTypeParameter());
+  case model::Kind::Variable:
+    return std::make_shared<Variable>(Type(), std::move(name), parent);
+  case model::Kind::Typedef:
+    return std::make_shared<Typedef>(Type(), std::move(name), parent);
+  case model::Kind::Macro:
+    return std::make_shared<Macro>(std::move(name), std::vector<std::string>(), parent);
+  default:
+    return nullptr;
+  }
+}
+
+std::shared_ptr<Entity> Reader::readEntity(const std::shared_ptr<Entity>& parent)
+{
+  const model::Kind k = readKind();
+  std::shared_ptr<Entity> e = create_entity(k, readString(), parent);
+
+  if (!e)
+    corrupted();
+
+  m_entities.push_back(e);
+
+  e->brief = readOptional();
+
+  if (readBool())
+    e->since = Since(readString());
+
+  if (readBool())
+    e->description = readDocument();
+
+  switch (k)
+  {
+  case model::Kind::Namespace:
+  {
+    readEntities(static_cast<Namespace&>(*e).entities, e);
+  }
+  break;
+  case model::Kind::Class:
+  {
+    auto& c = static_cast<Class&>(*e);
+    c.access_specifier = static_cast<AccessSpecifier>(readUInt());
+    c.is_struct = readBool();
+    c.is_final = readBool();
+    readTemplateParameters(c.template_parameters);
+    readEntities(c.members, e);
+  }
+  break;
+  case model::Kind::Enum:
+  {
+    auto& en = static_cast<Enum&>(*e);
+    en.access_specifier = static_cast<AccessSpecifier>(readUInt());
+    en.enum_class = readBool();
+
+    const size_t nvalues = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nvalues; ++i)
+      en.values.push_back(readEntity<EnumValue>(e));
+  }
+  break;
+  case model::Kind::EnumValue:
+  {
+    static_cast<EnumValue&>(*e).value() = readString();
+  }
+  break;
+  case model::Kind::Function:
+  {
+    auto& f = static_cast<Function&>(*e);
+    f.access_specifier = static_cast<AccessSpecifier>(readUInt());
+    f.return_type.type = readString();
+    f.return_type.brief = readOptional();
+    f.specifiers = static_cast<int>(readUInt());
+    f.category = static_cast<FunctionKind::Value>(readUInt());
+    readTemplateParameters(f.template_parameters);
+
+    const size_t nparams = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nparams; ++i)
+      f.parameters.push_back(readEntity<FunctionParameter>(e));
+  }
+  break;
+  case model::Kind::FunctionParameter:
+  {
+    auto& p = static_cast<FunctionParameter&>(*e);
+    p.type = readString();
+    p.default_value = readString();
+  }
+  break;
+  case model::Kind::TemplateParameter:
+  {
+    auto& tp = static_cast<TemplateParameter&>(*e);
+    std::optional<TemplateParameter> data;
+
+    if (readBool())
+    {
+      Type default_value = readString();
+      data.emplace(tp.name, TemplateTypeParameter(default_value));
+    }
+    else
+    {
+      Type type = readString();
+      data.emplace(tp.name, TemplateNonTypeParameter(type, readString()));
+    }
+
+    // the kind of parameter can only be set at construction
+    data->brief = std::move(tp.brief);
+    data->since = std::move(tp.since);
+    data->description = std::move(tp.description);
+    tp = std::move(*data);
+  }
+  break;
+  case model::Kind::Variable:
+  {
+    auto& v = static_cast<Variable&>(*e);
+    v.type() = readString();
+    v.specifiers() = static_cast<int>(readUInt());
+    v.defaultValue() = readString();
+  }
+  break;
+  case model::Kind::Typedef:
+  {
+    auto& t = static_cast<Typedef&>(*e);
+    t.access_specifier = static_cast<AccessSpecifier>(readUInt());
+    t.type = readString();
+  }
+  break;
+  case model::Kind::Macro:
+  {
+    auto& m = static_cast<Macro&>(*e);
+    const size_t nparams = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nparams; ++i)
+      m.parameters.push_back(readString());
+  }
+  break;
+  default:
+    break;
+  }
+
+  return e;
+}
+
+void Reader::readEntities(std::vector<std::shared_ptr<Entity>>& list, const std::shared_ptr<Entity>& parent)
+{
+  const size_t n = static_cast<size_t>(readUInt());
+
+  // every entity takes at least one byte
+  if (n > static_cast<size_t>(m_end - m_pos))
+    corrupted();
+
+  list.reserve(n);
+
+  for (size_t i(0); i < n; ++i)
+    list.push_back(readEntity(parent));
+}
+
+void Reader::readTemplateParameters(std::vector<std::shared_ptr<TemplateParameter>>& tparams)
+{
+  const size_t n = static_cast<size_t>(readUInt());
+
+  for (size_t i(0); i < n; ++i)
+    tparams.push_back(readEntity<TemplateParameter>(nullptr));
+}
+
+std::shared_ptr<Document> Reader::readDocument()
+{
+  const std::string_view doctype = readView();
+
+  std::shared_ptr<Document> doc;
+
+  if (doctype == "manual")
+    doc = std::make_shared<Manual>();
+  else if (doctype == "page")
+    doc = std::make_shared<Page>();
+  else
+    doc = std::make_shared<Document>();
+
+  m_documents.push_back(doc);
+
+  doc->doctype = std::string(doctype);
+  doc->title = readString();
+  readNodes(*doc);
+
+  return doc;
+}
+
+void Reader::readNodes(DocumentNode& parent)
+{
+  const size_t n = static_cast<size_t>(readUInt());
+
+  for (size_t i(0); i < n; ++i)
+    parent.appendChild(readNode());
+}
+
+std::shared_ptr<DocumentNode> Reader::readNode()
+{
+  const model::Kind k = readKind();
+  std::string id = readString();
+
+  std::shared_ptr<DocumentElement> result;
+
+  switch (k)
+  {
+  case model::Kind::Paragraph:
+  {
+    auto par = std::make_shared<Paragraph>();
+    readParagraph(*par);
+    result = par;
+  }
+  break;
+  case model::Kind::Sectioning:
+  {
+    const auto depth = static_cast<Sectioning::Depth>(static_cast<int>(readUInt()) - 1);
+    auto sec = std::make_shared<Sectioning>(depth, readString());
+    readNodes(*sec);
+    result = sec;
+  }
+  break;
+  case model::Kind::List:
+  {
+    auto l = std::make_shared<List>(readString());
+    l->ordered = readBool();
+    l->reversed = readBool();
+    readNodes(*l);
+    result = l;
+  }
+  break;
+  case model::Kind::ListItem:
+  {
+    auto li = std::make_shared<ListItem>();
+    li->marker = readString();
+    li->value = static_cast<int>(readUInt()) - 1;
+    readNodes(*li);
+    result = li;
+  }
+  break;
+  case model::Kind::Image:
+  {
+    auto img = std::make_shared<Image>(readString());
+    img->width = static_cast<int>(readUInt()) - 1;
+    img->height = static_cast<int>(readUInt()) - 1;
+    result = img;
+  }
+  break;
+  case model::Kind::CodeBlock:
+  {
+    auto cb = std::make_shared<CodeBlock>();
+    cb->lang = readString();
+    cb->code = readString();
+    result = cb;
+  }
+  break;
+  case model::Kind::DisplayMath:
+  {
+    auto math = std::make_shared<DisplayMath>();
+    math->source = readString();
+    result = math;
+  }
+  break;
+  case model::Kind::GroupTable:
+    result = std::make_shared<GroupTable>(readString());
+    break;
+  case model::Kind::BeginSince:
+  {
+    auto bsince = std::make_shared<BeginSince>(readString());
+    m_beginsinces.push_back(bsince);
+    result = bsince;
+  }
+  break;
+  case model::Kind::EndSince:
+    result = std::make_shared<EndSince>(get(m_beginsinces));
+    break;
+  case model::Kind::FrontMatter:
+    result = std::make_shared<FrontMatter>();
+    break;
+  case model::Kind::MainMatter:
+    result = std::make_shared<MainMatter>();
+    break;
+  case model::Kind::BackMatter:
+    result = std::make_shared<BackMatter>();
+    break;
+  case model::Kind::TableOfContents:
+    result = std::make_shared<TableOfContents>();
+    break;
+  case model::Kind::Index:
+    result = std::make_shared<Index>();
+    break;
+  default:
+    corrupted();
+  }
+
+  result->id = std::move(id);
+  return result;
+}
+
+void Reader::readParagraph(Paragraph& par)
+{
+  par.setText(readString());
+
+  const size_t n = static_cast<size_t>(readUInt());
+
+  for (size_t i(0); i < n; ++i)
+  {
+    const model::Kind k = readKind();
+    const size_t begin = static_cast<size_t>(readUInt());
+    const size_t end = static_cast<size_t>(readUInt());
+
+    if (begin > end || end > par.length())
+      corrupted();
+
+    const ParagraphRange range{ par, begin, end };
+
+    std::shared_ptr<ParagraphMetaData> md;
+
+    switch (k)
+    {
+    case model::Kind::Link:
+      md = std::make_shared<Link>(range, readString());
+      break;
+    case model::Kind::TextStyle:
+      md = std::make_shared<TextStyle>(range, readString());
+      break;
+    case model::Kind::Since:
+      md = std::make_shared<GenericParagraphMetaData<Since>>(range, Since(readString()));
+      break;
+    case model::Kind::IndexEntry:
+      md = std::make_shared<GenericParagraphMetaData<ParIndexEntry>>(range, ParIndexEntry(readString()));
+      break;
+    case model::Kind::InlineMath:
+      md = std::make_shared<GenericParagraphMetaData<InlineMath>>(range, InlineMath());
+      break;
+    default:
+      corrupted();
+    }
+
+    // metadata were written in sorted order, each one is appended
+    par.addMetaData(md);
+  }
+}
+
+std::shared_ptr<Model> Reader::readModel()
+{
+  auto model = std::make_shared<Model>();
+
+  if (readBool())
+  {
+    std::shared_ptr<Program> prog = model->getOrCreateProgram();
+    prog->global_namespace = readEntity<Namespace>(nullptr);
+
+    const size_t nmacros = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nmacros; ++i)
+      prog->macros.push_back(readEntity<Macro>(nullptr));
+
+    const size_t nderived = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nderived; ++i)
+    {
+      std::shared_ptr<Entity> c = get(m_entities);
+      const size_t nbases = static_cast<size_t>(readUInt());
+
+      if (!c || !c->is<Class>())
+        corrupted();
+
+      for (size_t j(0); j < nbases; ++j)
+      {
+        BaseClass b;
+        b.access_specifier = static_cast<AccessSpecifier>(readUInt());
+        std::shared_ptr<Entity> base = get(m_entities);
+        b.base = base && base->is<Class>() ? std::static_pointer_cast<Class>(base) : nullptr;
+        static_cast<Class&>(*c).bases.push_back(b);
+      }
+    }
+  }
+
+  const size_t ndocs = static_cast<size_t>(readUInt());
+
+  for (size_t i(0); i < ndocs; ++i)
+    model->documents.push_back(readDocument());
+
+  if (std::shared_ptr<Program> prog = model->program())
+  {
+    prog->symbols.build(prog->globalNamespace());
+
+    const size_t nrelated = static_cast<size_t>(readUInt());
+
+    for (size_t i(0); i < nrelated; ++i)
+    {
+      std::shared_ptr<Entity> c = get(m_entities);
+      const size_t nfuncs = static_cast<size_t>(readUInt());
+
+      for (size_t j(0); j < nfuncs; ++j)
+      {
+        std::shared_ptr<Entity> f = get(m_entities);
+
+        if (c && f && c->is<Class>() && f->is<Function>())
+          prog->related.relates(std::static_pointer_cast<Function>(f), std::static_pointer_cast<Class>(c));
+      }
+    }
+  }
+
+  const size_t ngroups = static_cast<size_t>(readUInt());
+
+  for (size_t i(0); i < ngroups; ++i)
+  {
+    std::shared_ptr<Group> g = model->groups.getOrCreate(readString());
+
+    const size_t nentities = static_cast<size_t>(readUInt());
+
+    for (size_t j(0); j < nentities; ++j)
+    {
+      if (std::shared_ptr<Entity> e = get(m_entities))
+        model->groups.insert(g, e);
+    }
+
+    const size_t ndocuments = static_cast<size_t>(readUInt());
+
+    for (size_t j(0); j < ndocuments; ++j)
+    {
+      if (std::shared_ptr<Document> d = get(m_documents))
+        model->groups.insert(g, d);
+    }
+  }
+
+  if (m_pos != m_end)
+    corrupted();
+
+  return model;
+}
+
+void save(const Model& model, std::ostream& out)
+{
+  Writer writer;
+  writer.writeModel(model);
+  writer.flush(out);
+}
+
+void save(const Model& model, const std::filesystem::path& file)
+{
+  std::ofstream out{ file, std::ios::out | std::ios::binary | std::ios::trunc };
+
+  if (!out.good())
+    throw IOException{ file.string(), "could not open file for writing" };
+
+  save(model, out);
+}
+
+std::shared_ptr<Model> load(const char* data, size_t size)
+{
+  Reader reader{ data, size };
+  return reader.readModel();
+}
+
+std::shared_ptr<Model> load(const std::filesystem::path& file)
+{
+  file_utils::MappedFile mapping{ file };
+  return load(mapping.data(), mapping.size());
+}
+
+} // namespace snapshot
+
+} // namespace dex
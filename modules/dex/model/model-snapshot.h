@@ -0,0 +1,38 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_MODEL_MODELSNAPSHOT_H
+#define DEX_MODEL_MODELSNAPSHOT_H
+
+#include "dex/dex-model.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+
+namespace dex
+{
+
+class Model;
+
+// Versioned binary image of a Model (program, documents, paragraph
+// metadata, groups and related non-members).
+// Math lists are not stored: loaded math nodes only keep their source.
+namespace snapshot
+{
+
+constexpr uint32_t version = 1;
+
+DEX_MODEL_API void save(const Model& model, std::ostream& out);
+DEX_MODEL_API void save(const Model& model, const std::filesystem::path& file);
+
+DEX_MODEL_API std::shared_ptr<Model> load(const char* data, size_t size);
+DEX_MODEL_API std::shared_ptr<Model> load(const std::filesystem::path& file);
+
+} // namespace snapshot
+
+} // namespace dex
+
+#endif // DEX_MODEL_MODELSNAPSHOT_H
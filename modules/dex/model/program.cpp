@@ -4,6 +4,9 @@
 
 #include "dex/model/program.h"
 
+#include "dex/model/frozen-program.h"
+
+#include <atomic>
 #include <stdexcept>
 
 namespace dex
@@ -22,6 +25,20 @@ std::string to_string(dex::AccessSpecifier as)
   }
 }
 
+static std::atomic<size_t> g_entity_generation{ 0 };
+
+Entity::Entity(std::string n, std::shared_ptr<Entity> parent)
+  : name(std::move(n)),
+  weak_parent(parent)
+{
+  g_entity_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t Entity::generation()
+{
+  return g_entity_generation.load(std::memory_order_relaxed);
+}
+
 std::shared_ptr<Entity> Entity::shared_from_this()
 {
   return std::static_pointer_cast<Entity>(model::Object::shared_from_this());
@@ -172,7 +189,7 @@ bool TemplateArgument::isType() const
 
 std::string TemplateArgument::toString() const
 {
-  return isType() ? get<Type>() : get<std::string>();
+  return get<std::string>();
 }
 
 
@@ -509,50 +526,35 @@ model::Kind Program::kind() const
   return ClassKind;
 }
 
-static std::shared_ptr<Entity> resolve_impl(const std::string& name, const std::shared_ptr<Entity>& context)
+std::shared_ptr<Entity> Program::resolve(const Name& n)
+{
+  return resolve(n, globalNamespace());
+}
+
+std::shared_ptr<Entity> Program::resolve(const Name& n, const std::shared_ptr<Entity>& context)
 {
   if (!context)
     return nullptr;
 
-  if (context->is<Namespace>())
-  {
-    const Namespace& ns = static_cast<const Namespace&>(*context);
+  std::shared_ptr<Entity> result = symbols.resolve(n, context);
 
-    for (const auto& e : ns.entities)
-    {
-      if (e->name == name)
-        return e;
-    }
-
-    return resolve_impl(name, context->parent());
-  }
-  else if (context->is<Class>())
+  // entities that were not added by the parser are not registered,
+  // the table is rebuilt before reporting a miss if entities were created
+  // since the last rebuild
+  if (!result && m_symbols_generation != Entity::generation())
   {
-    const Class& cla = static_cast<const Class&>(*context);
-
-    for (const auto& mem : cla.members)
-    {
-      if (mem->name == name)
-        return mem;
-    }
-
-    return resolve_impl(name, context->parent());
+    m_symbols_generation = Entity::generation();
+    symbols.clear();
+    symbols.build(globalNamespace());
+    result = symbols.resolve(n, context);
   }
 
-  return nullptr;
-}
-
-std::shared_ptr<Entity> Program::resolve(const Name& n)
-{
-  return resolve(n, globalNamespace());
+  return result;
 }
 
-std::shared_ptr<Entity> Program::resolve(const Name& n, const std::shared_ptr<Entity>& context)
+std::shared_ptr<const FrozenProgram> Program::freeze() const
 {
-  if (!context)
-    return nullptr;
-
-  return resolve_impl(n, context);
+  return std::make_shared<const FrozenProgram>(*this);
 }
 
 } // namespace dex
@@ -7,9 +7,12 @@
 
 #include "dex/dex-model.h"
 
+#include "dex/common/string-pool.h"
+
 #include "dex/model/model-base.h"
 #include "dex/model/since.h"
 #include "dex/model/document.h"
+#include "dex/model/symbol-table.h"
 
 #include <algorithm>
 #include <optional>
@@ -21,9 +24,10 @@ namespace dex
 
 class Class;
 class Enum;
+class FrozenProgram;
 class Function;
 
-using Type = std::string;
+using Type = InternedString;
 using Expression = std::string;
 using Name = std::string;
 
@@ -39,7 +43,7 @@ DEX_MODEL_API std::string to_string(dex::AccessSpecifier as);
 class DEX_MODEL_API Entity : public model::Object
 {
 public:
-  std::string name;
+  InternedString name;
   std::weak_ptr<Entity> weak_parent;
   std::optional<std::string> brief;
   std::optional<Since> since;
@@ -60,14 +64,10 @@ public:
 
   template<typename T>
   static std::shared_ptr<T> find(const std::string& name, const std::vector<std::shared_ptr<T>>& entities);
-};
-
-inline Entity::Entity(std::string n, std::shared_ptr<Entity> parent)
-  : name(std::move(n)),
-  weak_parent(parent)
-{
 
-}
+  // number of entities created so far, in any program
+  static size_t generation();
+};
 
 inline std::shared_ptr<Entity> Entity::parent() const
 {
@@ -230,6 +230,12 @@ public:
     return std::get<T>(m_data).default_value;
   }
 
+  template<typename T>
+  const T& get() const
+  {
+    return std::get<T>(m_data);
+  }
+
   TemplateParameter& operator=(const TemplateParameter&) = default;
   TemplateParameter& operator=(TemplateParameter&&) = default;
 };
@@ -694,6 +700,7 @@ public:
   std::vector<std::shared_ptr<File>> files;
   std::shared_ptr<Namespace> global_namespace;
   RelatedNonMembers related;
+  SymbolTable symbols;
 
 public:
   Program();
@@ -706,6 +713,13 @@ public:
 
   std::shared_ptr<Entity> resolve(const Name& n);
   std::shared_ptr<Entity> resolve(const Name& n, const std::shared_ptr<Entity>& context);
+
+  // flattened view of the program as it is now, later changes to the
+  // program are not reflected in the view
+  std::shared_ptr<const FrozenProgram> freeze() const;
+
+private:
+  size_t m_symbols_generation = 0; // Entity::generation() when 'symbols' was last rebuilt
 };
 
 inline const std::shared_ptr<Namespace>& Program::globalNamespace() const
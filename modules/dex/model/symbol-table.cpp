@@ -0,0 +1,212 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/model/symbol-table.h"
+
+#include "dex/model/program.h"
+
+#include <algorithm>
+
+namespace dex
+{
+
+static const SymbolTable::OverloadSet& empty_overload_set()
+{
+  static const SymbolTable::OverloadSet static_instance = {};
+  return static_instance;
+}
+
+static bool is_scope(const Entity& e)
+{
+  return e.is<Namespace>() || e.is<Class>() || e.is<Enum>();
+}
+
+bool SymbolTable::empty() const
+{
+  return m_size == 0;
+}
+
+size_t SymbolTable::size() const
+{
+  return m_size;
+}
+
+void SymbolTable::insert(const std::shared_ptr<Entity>& e)
+{
+  // unnamed entities (e.g. anonymous namespaces) cannot be looked up,
+  // their content is found through the enclosing scope
+  if (e->name.empty() || m_names.count(e.get()))
+    return;
+
+  const std::string qualname = compute_qualified_name(*e);
+
+  // the table holds a reference to 'e', its address cannot be reused
+  // while it is in m_names
+  m_names[e.get()] = qualname;
+  m_qualified_names[qualname].push_back(e);
+
+  size_t pos = 0;
+
+  for (;;)
+  {
+    m_suffixes[qualname.substr(pos)].push_back(e);
+
+    pos = qualname.find("::", pos);
+
+    if (pos == std::string::npos)
+      break;
+
+    pos += 2;
+  }
+
+  ++m_size;
+}
+
+void SymbolTable::remove(const std::shared_ptr<Entity>& e)
+{
+  auto it = m_names.find(e.get());
+
+  if (it == m_names.end())
+    return;
+
+  const std::string qualname = std::move(it->second);
+  m_names.erase(it);
+
+  erase_from(m_qualified_names, qualname, e);
+
+  size_t pos = 0;
+
+  for (;;)
+  {
+    erase_from(m_suffixes, qualname.substr(pos), e);
+
+    pos = qualname.find("::", pos);
+
+    if (pos == std::string::npos)
+      break;
+
+    pos += 2;
+  }
+
+  --m_size;
+}
+
+void SymbolTable::clear()
+{
+  m_qualified_names.clear();
+  m_suffixes.clear();
+  m_names.clear();
+  m_size = 0;
+}
+
+void SymbolTable::build(const std::shared_ptr<Entity>& root)
+{
+  if (!root)
+    return;
+
+  insert(root);
+
+  if (root->is<Namespace>())
+  {
+    for (const auto& e : static_cast<const Namespace&>(*root).entities)
+      build(e);
+  }
+  else if (root->is<Class>())
+  {
+    for (const auto& m : static_cast<const Class&>(*root).members)
+      build(m);
+  }
+  else if (root->is<Enum>())
+  {
+    for (const auto& v : static_cast<const Enum&>(*root).values)
+      build(v);
+  }
+}
+
+std::string SymbolTable::qualifiedName(const Entity& e) const
+{
+  auto it = m_names.find(&e);
+  return it != m_names.end() ? it->second : compute_qualified_name(e);
+}
+
+const SymbolTable::OverloadSet& SymbolTable::lookup(const std::string& qualified_name) const
+{
+  auto it = m_qualified_names.find(qualified_name);
+  return it != m_qualified_names.end() ? it->second : empty_overload_set();
+}
+
+const SymbolTable::OverloadSet& SymbolTable::lookupSuffix(const std::string& name) const
+{
+  auto it = m_suffixes.find(name);
+  return it != m_suffixes.end() ? it->second : empty_overload_set();
+}
+
+std::shared_ptr<Entity> SymbolTable::find(const std::string& qualified_name) const
+{
+  const OverloadSet& overloads = lookup(qualified_name);
+  return overloads.empty() ? nullptr : overloads.front();
+}
+
+std::shared_ptr<Entity> SymbolTable::resolve(const std::string& name, const std::shared_ptr<Entity>& context) const
+{
+  if (name.size() > 2 && name.compare(0, 2, "::") == 0)
+    return find(name.substr(2));
+
+  std::shared_ptr<Entity> scope = context;
+
+  while (scope && !is_scope(*scope))
+    scope = scope->parent();
+
+  std::shared_ptr<Entity> result;
+
+  for (; scope != nullptr && result == nullptr; scope = scope->parent())
+  {
+    const std::string prefix = qualifiedName(*scope);
+    result = find(prefix.empty() ? name : prefix + "::" + name);
+  }
+
+  return result;
+}
+
+std::string SymbolTable::compute_qualified_name(const Entity& e)
+{
+  std::vector<const std::string*> names;
+
+  if (!e.name.empty())
+    names.push_back(&e.name.str());
+
+  for (auto p = e.parent(); p != nullptr; p = p->parent())
+  {
+    if (!p->name.empty())
+      names.push_back(&p->name.str());
+  }
+
+  std::string result;
+
+  for (auto it = names.rbegin(); it != names.rend(); ++it)
+  {
+    if (!result.empty())
+      result += "::";
+
+    result += **it;
+  }
+
+  return result;
+}
+
+void SymbolTable::erase_from(std::unordered_map<std::string, OverloadSet>& map, const std::string& key, const std::shared_ptr<Entity>& e)
+{
+  auto it = map.find(key);
+
+  if (it == map.end())
+    return;
+
+  OverloadSet& set = it->second;
+  set.erase(std::remove(set.begin(), set.end(), e), set.end());
+
+  if (set.empty())
+    map.erase(it);
+}
+
+} // namespace dex
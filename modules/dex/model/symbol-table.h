@@ -0,0 +1,65 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_MODEL_SYMBOLTABLE_H
+#define DEX_MODEL_SYMBOLTABLE_H
+
+#include "dex/dex-model.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dex
+{
+
+class Entity;
+
+// Maps fully qualified names (e.g. "a::b::C") and each of their
+// suffixes ("b::C", "C") to the entities (overload sets) declaring them.
+// Unnamed scopes, such as anonymous namespaces, do not appear in names.
+// Entities are expected to be inserted once they have been attached to
+// their parent; an entity that is re-parented must be removed first.
+// Const member functions do not modify the table and may be called
+// concurrently.
+class DEX_MODEL_API SymbolTable
+{
+public:
+  typedef std::vector<std::shared_ptr<Entity>> OverloadSet;
+
+public:
+  SymbolTable() = default;
+
+  bool empty() const;
+  size_t size() const;
+
+  void insert(const std::shared_ptr<Entity>& e);
+  void remove(const std::shared_ptr<Entity>& e);
+  void clear();
+
+  void build(const std::shared_ptr<Entity>& root);
+
+  std::string qualifiedName(const Entity& e) const;
+
+  const OverloadSet& lookup(const std::string& qualified_name) const;
+  const OverloadSet& lookupSuffix(const std::string& name) const;
+
+  std::shared_ptr<Entity> find(const std::string& qualified_name) const;
+  std::shared_ptr<Entity> resolve(const std::string& name, const std::shared_ptr<Entity>& context) const;
+
+protected:
+  static std::string compute_qualified_name(const Entity& e);
+  static void erase_from(std::unordered_map<std::string, OverloadSet>& map, const std::string& key, const std::shared_ptr<Entity>& e);
+
+private:
+  std::unordered_map<std::string, OverloadSet> m_qualified_names;
+  std::unordered_map<std::string, OverloadSet> m_suffixes;
+  std::unordered_map<const Entity*, std::string> m_names; // of the inserted entities
+  size_t m_size = 0;
+};
+
+} // namespace dex
+
+#endif // DEX_MODEL_SYMBOLTABLE_H
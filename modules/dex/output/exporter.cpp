@@ -5,7 +5,11 @@
 #include "dex/output/exporter.h"
 
 #include "dex/output/config.h"
-#include "dex/output/json/json-export.h"
+#include "dex/output/json/json-cbor.h"
+#include "dex/output/json/json-shards.h"
+#include "dex/output/json/json-stream.h"
+#include "dex/output/output-sink.h"
+#include "dex/output/output-sync.h"
 
 #ifdef DEX_EXPORTER_LIQUID_ENABLED
 #include "dex/output/liquid/liquid-exporter.h"
@@ -15,8 +19,6 @@
 #include "dex/common/file-utils.h"
 #include "dex/common/logging.h"
 
-#include <json-toolkit/stringify.h>
-
 namespace dex
 {
 
@@ -31,11 +33,42 @@ void run_exporter(const std::shared_ptr<dex::Model>& model, const std::filesyste
 
   if (engine == "json")
   {
-    auto obj = dex::JsonExporter::serialize(*model);
+    dex::OutputSync sync{ outdirpath / "_output" };
+
+    // only the files of the json engine are pruned, e.g. the output of a
+    // previous export in the other mode; other files in _output are left untouched
+    if (dex::config::read(config, "sharded", false).toBool())
+    {
+      dex::JsonShardedExporter exporter{ *model, sync };
+      exporter.setThreads(static_cast<size_t>(dex::config::read(config, "threads", 0).toInt()));
+      exporter.write();
+      sync.prune({ "dex.json" });
+    }
+    else
+    {
+      // dex.json is only replaced if its content changed
+      sync.stream(outdirpath / "_output" / "dex.json", [&model](dex::OutputSink& sink) {
+        dex::JsonStreamExporter::write(*model, sink);
+      });
+
+      sync.prune({ "manifest.json", "entities", "documents" });
+    }
+
+    dex::log_summary(sync.summary());
+
+    return;
+  }
+  else if (engine == "cbor")
+  {
+    // same schema as the "json" engine, encoded as CBOR
+    dex::OutputSync sync{ outdirpath / "_output" };
 
-    std::filesystem::create_directory(outdirpath / "_output");
+    sync.stream(outdirpath / "_output" / "dex.cbor", [&model](dex::OutputSink& sink) {
+      dex::CborExporter::write(*model, sink);
+    });
 
-    dex::file_utils::write_file(outdirpath / "_output" / "dex.json", json::stringify(obj));
+    sync.prune({ "dex.cbor" });
+    dex::log_summary(sync.summary());
 
     return;
   }
@@ -0,0 +1,291 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/json/json-cbor.h"
+
+#include "dex/output/output-sink.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace dex
+{
+
+namespace
+{
+
+enum CborMajorType
+{
+  UnsignedInteger = 0,
+  NegativeInteger = 1,
+  ByteString = 2,
+  TextString = 3,
+  ArrayType = 4,
+  MapType = 5,
+  Tag = 6,
+  SimpleValue = 7,
+};
+
+constexpr uint8_t CborIndefiniteLength = 31;
+constexpr uint8_t CborFalse = 0xF4;
+constexpr uint8_t CborTrue = 0xF5;
+constexpr uint8_t CborBreak = 0xFF;
+
+class CborDecoder
+{
+public:
+  const std::string& data;
+  size_t pos = 0;
+
+public:
+  explicit CborDecoder(const std::string& d)
+    : data(d)
+  {
+
+  }
+
+  json::Json read()
+  {
+    const uint8_t initial = next();
+    const int major_type = initial >> 5;
+    const uint8_t info = initial & 0x1F;
+
+    switch (major_type)
+    {
+    case UnsignedInteger:
+    {
+      uint64_t n = readArgument(info);
+
+      if (n > uint64_t(std::numeric_limits<int>::max()))
+        throw std::runtime_error{ "cbor: integer out of range" };
+
+      return json::Json(int(n));
+    }
+    case NegativeInteger:
+    {
+      uint64_t n = readArgument(info);
+
+      if (n > uint64_t(std::numeric_limits<int>::max()))
+        throw std::runtime_error{ "cbor: integer out of range" };
+
+      return json::Json(-1 - int(n));
+    }
+    case TextString:
+      return json::Json(readString(info));
+    case ArrayType:
+    {
+      json::Array result;
+
+      if (info == CborIndefiniteLength)
+      {
+        while (!atBreak())
+          result.push(read());
+      }
+      else
+      {
+        for (uint64_t n = readArgument(info); n > 0; --n)
+          result.push(read());
+      }
+
+      return result;
+    }
+    case MapType:
+    {
+      json::Object result;
+
+      if (info == CborIndefiniteLength)
+      {
+        while (!atBreak())
+          readField(result);
+      }
+      else
+      {
+        for (uint64_t n = readArgument(info); n > 0; --n)
+          readField(result);
+      }
+
+      return result;
+    }
+    case SimpleValue:
+    {
+      if (initial == CborFalse)
+        return json::Json(false);
+      else if (initial == CborTrue)
+        return json::Json(true);
+    }
+    [[fallthrough]];
+    default:
+      throw std::runtime_error{ "cbor: unsupported data item" };
+    }
+  }
+
+protected:
+  uint8_t next()
+  {
+    if (pos >= data.size())
+      throw std::runtime_error{ "cbor: unexpected end of data" };
+
+    return static_cast<uint8_t>(data[pos++]);
+  }
+
+  bool atBreak()
+  {
+    if (pos < data.size() && static_cast<uint8_t>(data[pos]) == CborBreak)
+    {
+      ++pos;
+      return true;
+    }
+
+    return false;
+  }
+
+  uint64_t readArgument(uint8_t info)
+  {
+    if (info < 24)
+      return info;
+
+    if (info > 27)
+      throw std::runtime_error{ "cbor: invalid argument" };
+
+    const int nbytes = 1 << (info - 24);
+    uint64_t result = 0;
+
+    for (int i(0); i < nbytes; ++i)
+      result = (result << 8) | next();
+
+    return result;
+  }
+
+  std::string readString(uint8_t info)
+  {
+    if (info == CborIndefiniteLength)
+      throw std::runtime_error{ "cbor: indefinite-length strings are not supported" };
+
+    const uint64_t len = readArgument(info);
+
+    if (len > data.size() - pos)
+      throw std::runtime_error{ "cbor: unexpected end of data" };
+
+    std::string result = data.substr(pos, static_cast<size_t>(len));
+    pos += static_cast<size_t>(len);
+    return result;
+  }
+
+  void readField(json::Object& obj)
+  {
+    const uint8_t initial = next();
+
+    if ((initial >> 5) != TextString)
+      throw std::runtime_error{ "cbor: map keys must be strings" };
+
+    std::string key = readString(initial & 0x1F);
+    obj[key] = read();
+  }
+};
+
+} // namespace
+
+CborStreamWriter::CborStreamWriter(OutputSink& out)
+  : m_out(out)
+{
+
+}
+
+void CborStreamWriter::beginObject()
+{
+  m_out.write(char((MapType << 5) | CborIndefiniteLength));
+}
+
+void CborStreamWriter::endObject()
+{
+  m_out.write(char(CborBreak));
+}
+
+void CborStreamWriter::beginArray()
+{
+  m_out.write(char((ArrayType << 5) | CborIndefiniteLength));
+}
+
+void CborStreamWriter::endArray()
+{
+  m_out.write(char(CborBreak));
+}
+
+void CborStreamWriter::key(const char* name)
+{
+  writeString(name, std::strlen(name));
+}
+
+void CborStreamWriter::value(const std::string& str)
+{
+  writeString(str.data(), str.size());
+}
+
+void CborStreamWriter::value(const char* str)
+{
+  writeString(str, std::strlen(str));
+}
+
+void CborStreamWriter::value(int n)
+{
+  if (n >= 0)
+    writeHead(UnsignedInteger, uint64_t(n));
+  else
+    writeHead(NegativeInteger, uint64_t(-1 - int64_t(n)));
+}
+
+void CborStreamWriter::value(bool b)
+{
+  m_out.write(char(b ? CborTrue : CborFalse));
+}
+
+void CborStreamWriter::writeHead(int major_type, uint64_t arg)
+{
+  char buffer[9];
+  const char mt = char(major_type << 5);
+
+  if (arg < 24)
+  {
+    m_out.write(char(mt | char(arg)));
+    return;
+  }
+
+  // the argument follows in 1, 2, 4 or 8 big-endian bytes
+  int nbytes = arg <= 0xFF ? 1 : (arg <= 0xFFFF ? 2 : (arg <= 0xFFFFFFFF ? 4 : 8));
+  int info = nbytes == 1 ? 24 : (nbytes == 2 ? 25 : (nbytes == 4 ? 26 : 27));
+
+  buffer[0] = char(mt | char(info));
+
+  for (int i(0); i < nbytes; ++i)
+    buffer[nbytes - i] = char((arg >> (8 * i)) & 0xFF);
+
+  m_out.write(buffer, size_t(nbytes) + 1);
+}
+
+void CborStreamWriter::writeString(const char* str, size_t len)
+{
+  writeHead(TextString, len);
+  m_out.write(str, len);
+}
+
+void CborExporter::write(const Model& model, OutputSink& out)
+{
+  CborStreamWriter writer{ out };
+  JsonStreamExporter ex{ model };
+  ex.write(writer);
+}
+
+json::Json CborExporter::decode(const std::string& data)
+{
+  CborDecoder decoder{ data };
+  json::Json result = decoder.read();
+
+  if (decoder.pos != data.size())
+    throw std::runtime_error{ "cbor: trailing data" };
+
+  return result;
+}
+
+} // namespace dex
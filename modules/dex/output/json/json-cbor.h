@@ -0,0 +1,61 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_JSON_CBOR_H
+#define DEX_OUTPUT_JSON_CBOR_H
+
+#include "dex/output/json/json-stream.h"
+
+#include <json-toolkit/json.h>
+
+#include <cstdint>
+#include <string>
+
+namespace dex
+{
+
+class Model;
+class OutputSink;
+
+// Encodes JSON tokens as CBOR (RFC 8949).
+// Objects and arrays use indefinite-length encoding so that their size
+// need not be known in advance.
+class DEX_OUTPUT_API CborStreamWriter : public JsonTokenWriter
+{
+public:
+  explicit CborStreamWriter(OutputSink& out);
+
+  void beginObject() override;
+  void endObject() override;
+  void beginArray() override;
+  void endArray() override;
+
+  void key(const char* name) override;
+
+  void value(const std::string& str) override;
+  void value(const char* str) override;
+  void value(int n) override;
+  void value(bool b) override;
+
+protected:
+  void writeHead(int major_type, uint64_t arg);
+  void writeString(const char* str, size_t len);
+
+private:
+  OutputSink& m_out;
+};
+
+// CBOR counterpart of JsonExporter, with the same schema.
+class DEX_OUTPUT_API CborExporter
+{
+public:
+  static void write(const Model& model, OutputSink& out);
+
+  // Decodes the subset of CBOR written by CborStreamWriter
+  static json::Json decode(const std::string& data);
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_JSON_CBOR_H
@@ -64,6 +64,16 @@ static json::Json serialize_par_metadata(const dex::ParagraphMetaData& pmd)
   return result;
 }
 
+static json::Array group_paths(const std::vector<std::shared_ptr<Group>>& groups)
+{
+  json::Array result;
+
+  for (const auto& g : groups)
+    result.push("$.groups[" + std::to_string(g->index) + "]");
+
+  return result;
+}
+
 JsonExporter::JsonExporter(const Model& m)
   : model(m)
 {
@@ -83,7 +93,11 @@ json::Object JsonExporter::serialize()
   if (model.program())
   {
     JsonProgramSerializer progserializer{ };
+    progserializer.groups = &model.groups;
     result["program"] = progserializer.serialize(*model.program());
+
+    // reused for the references to entities in groups
+    m_paths = std::move(progserializer.paths);
   }
 
   if (!model.documents.empty())
@@ -93,6 +107,7 @@ json::Object JsonExporter::serialize()
     for (size_t i(0); i < model.documents.size(); ++i)
     {
       JsonDocumentSerializer docserializer{ };
+      docserializer.groups = &model.groups;
       docs.push(docserializer.serialize(*model.documents.at(i)));
     }
 
@@ -124,12 +139,15 @@ json::Object JsonExporter::serializeGroup(const Group& group)
     json::Array ets;
 
     JsonProgramSerializer progser{ };
+    std::swap(progser.paths, m_paths);
 
     for (auto e : group.content.entities)
     {
-      ets.push(progser.path(*e, *model.program()));
+      ets.push(progser.entityPath(*e, *model.program()));
     }
 
+    std::swap(progser.paths, m_paths);
+
     res["entities"] = ets;
   }
 
@@ -158,6 +176,9 @@ json::Object JsonDocumentSerializer::serialize(dex::Document& doc)
   result["doctype"] = doc.doctype;
   result["content"] = serializeArray(doc.childNodes());
 
+  if (groups && !groups->groupsOf(doc).empty())
+    result["groups"] = group_paths(groups->groupsOf(doc));
+
   return result;
 }
 
@@ -297,6 +318,8 @@ void JsonDocumentSerializer::visit(dex::Index& idx)
 
 json::Object JsonProgramSerializer::serialize(dex::Program& prog)
 {
+  paths[prog.globalNamespace().get()] = "$.program.global_namespace";
+
   result["global_namespace"] = serialize(*prog.globalNamespace());
 
   if (!prog.macros.empty())
@@ -373,6 +396,46 @@ std::string JsonProgramSerializer::path(dex::Entity& e, dex::Program& prog)
   }
 }
 
+void JsonProgramSerializer::computePaths(dex::Program& prog, JsonPathMap& paths)
+{
+  std::vector<dex::Entity*> stack;
+  paths[prog.globalNamespace().get()] = "$.program.global_namespace";
+  stack.push_back(prog.globalNamespace().get());
+
+  while (!stack.empty())
+  {
+    dex::Entity* e = stack.back();
+    stack.pop_back();
+
+    if (e->is<dex::Namespace>())
+    {
+      auto& ns = static_cast<dex::Namespace&>(*e);
+      recordPaths(paths, ns, ns.entities, ".entities[");
+
+      for (const auto& child : ns.entities)
+        stack.push_back(child.get());
+    }
+    else if (e->is<dex::Class>())
+    {
+      auto& cla = static_cast<dex::Class&>(*e);
+      recordPaths(paths, cla, cla.members, ".members[");
+
+      for (const auto& child : cla.members)
+        stack.push_back(child.get());
+    }
+  }
+}
+
+std::string JsonProgramSerializer::entityPath(dex::Entity& e, dex::Program& prog) const
+{
+  auto it = paths.find(&e);
+
+  if (it != paths.end())
+    return it->second;
+
+  return path(e, prog);
+}
+
 json::Array JsonProgramSerializer::serializeArray(const std::vector<std::shared_ptr<dex::Entity>>& nodes)
 {
   json::Array res;
@@ -390,13 +453,13 @@ json::Array JsonProgramSerializer::serializeRelatedMembers(dex::RelatedNonMember
   for (const auto& e : rnm.class_map)
   {
     json::Object json_entry{};
-    json_entry["class"] = path(*(e.second->the_class), prog);
+    json_entry["class"] = entityPath(*(e.second->the_class), prog);
 
     json::Array json_functions;
 
     for (auto f : e.second->non_members)
     {
-      json_functions.push(path(*f, prog));
+      json_functions.push(entityPath(*f, prog));
     }
 
     json_entry["functions"] = json_functions;
@@ -436,25 +499,33 @@ void JsonProgramSerializer::write_documentation(dex::Entity& e)
 
 void JsonProgramSerializer::visit(dex::Entity& e)
 {
-  result["name"] = e.name;
+  result["name"] = e.name.str();
   result["type"] = to_string(e.kind());
 
   //write_location(result, e.location);
   write_documentation(e);
 
+  if (groups && !groups->groupsOf(e).empty())
+    result["groups"] = group_paths(groups->groupsOf(e));
+
   dispatch(e);
 }
 
 void JsonProgramSerializer::visit(dex::Namespace& ns)
 {
-  if(!ns.entities.empty())
+  if (!ns.entities.empty())
+  {
+    recordPaths(paths, ns, ns.entities, ".entities[");
     result["entities"] = serializeArray(ns.entities);
+  }
 }
 
 void JsonProgramSerializer::visit(dex::Class& cla)
 {
   if (!cla.members.empty())
   {
+    recordPaths(paths, cla, cla.members, ".members[");
+
     json::Array members = serializeArray(cla.members);
 
     for (size_t i(0); i < cla.members.size(); ++i)
@@ -483,7 +554,7 @@ void JsonProgramSerializer::visit(dex::Function& f)
     result["parameters"] = serializeArray(f.parameters);
   }
 
-  result["return_type"] = f.return_type.type;
+  result["return_type"] = f.return_type.type.str();
 
   if (f.specifiers != 0)
   {
@@ -493,7 +564,7 @@ void JsonProgramSerializer::visit(dex::Function& f)
 
 void JsonProgramSerializer::visit(dex::FunctionParameter& fp)
 {
-  result["type"] = fp.type;
+  result["type"] = fp.type.str();
   write_if(result, "default_value", fp.default_value, fp.default_value != dex::Expression());
 
   if (fp.brief.has_value())
@@ -502,7 +573,7 @@ void JsonProgramSerializer::visit(dex::FunctionParameter& fp)
 
 void JsonProgramSerializer::visit(dex::Variable& v)
 {
-  result["vartype"] = v.type();
+  result["vartype"] = v.type().str();
   write_if(result, "default_value", v.defaultValue(), v.defaultValue() != dex::Expression());
 
   if (v.specifiers() != 0)
@@ -524,7 +595,7 @@ void JsonProgramSerializer::visit(dex::Variable& v)
 
 void JsonProgramSerializer::visit(dex::Typedef& t)
 {
-  result["typedef"] = t.type;
+  result["typedef"] = t.type.str();
 }
 
 void JsonProgramSerializer::visit(dex::Macro& m)
@@ -9,9 +9,14 @@
 
 #include "dex/model/model-visitor.h"
 
+#include <unordered_map>
+
 namespace dex
 {
 
+// JSONPath of the serialized entities, e.g. "$.program.global_namespace.entities[0]"
+using JsonPathMap = std::unordered_map<const dex::Entity*, std::string>;
+
 class DEX_OUTPUT_API JsonExporter
 {
 public:
@@ -27,12 +32,15 @@ protected:
 
   json::Object serializeGroup(const Group& group);
 
+private:
+  JsonPathMap m_paths;
 };
 
 class JsonDocumentSerializer : public DocumentVisitor
 {
 public:
   json::Object result;
+  const GroupManager* groups = nullptr;
 
 public:
   JsonDocumentSerializer()
@@ -71,6 +79,8 @@ class JsonProgramSerializer : public ProgramVisitor
 {
 public:
   json::Object result;
+  const GroupManager* groups = nullptr;
+  JsonPathMap paths; // filled as entities are serialized
 
 public:
   JsonProgramSerializer()
@@ -82,6 +92,9 @@ public:
   json::Object serialize(dex::Entity& e);
 
   static std::string path(dex::Entity& e, dex::Program& prog);
+  static void computePaths(dex::Program& prog, JsonPathMap& paths);
+
+  std::string entityPath(dex::Entity& e, dex::Program& prog) const;
 
 private:
   json::Array serializeArray(const std::vector<std::shared_ptr<dex::Entity>>& nodes);
@@ -99,6 +112,20 @@ private:
 
   json::Array serializeRelatedMembers(dex::RelatedNonMembers& rnm, dex::Program& prog);
 
+  template<typename T>
+  static void recordPaths(JsonPathMap& paths, dex::Entity& parent, const std::vector<std::shared_ptr<T>>& children, const char* field)
+  {
+    auto it = paths.find(&parent);
+
+    if (it == paths.end())
+      return;
+
+    const std::string prefix = it->second + field;
+
+    for (size_t i(0); i < children.size(); ++i)
+      paths[children.at(i).get()] = prefix + std::to_string(i) + "]";
+  }
+
   void write_documentation(dex::Entity& e);
 
   void visit(dex::Entity& e) override;
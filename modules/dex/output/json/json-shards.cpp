@@ -0,0 +1,339 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/json/json-shards.h"
+
+#include "dex/output/json/json-export.h"
+#include "dex/output/json/json-stream.h"
+#include "dex/output/output-sink.h"
+#include "dex/output/output-sync.h"
+
+#include "dex/model/model.h"
+#include "dex/model/model-diff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace dex
+{
+
+class JsonShardWriter : public JsonStreamExporter
+{
+public:
+  const std::unordered_map<const Entity*, std::string>& files;
+  const Entity* root = nullptr;
+
+public:
+  JsonShardWriter(const Model& m, const std::unordered_map<const Entity*, std::string>& shard_files)
+    : JsonStreamExporter(m),
+      files(shard_files)
+  {
+
+  }
+
+  void writeShard(const JsonShardedExporter::Shard& shard, OutputSink& out)
+  {
+    JsonStreamWriter writer{ out };
+    m_writer = &writer;
+
+    if (shard.entity)
+    {
+      root = shard.entity.get();
+      writeEntity(*shard.entity, nullptr);
+    }
+    else
+    {
+      writeDocument(*shard.document);
+    }
+
+    m_writer = nullptr;
+  }
+
+  void writeManifest(const std::vector<JsonShardedExporter::Shard>& shards, OutputSink& out)
+  {
+    JsonStreamWriter writer{ out };
+    m_writer = &writer;
+    m_writer->beginObject();
+
+    m_writer->key("documents");
+    m_writer->beginArray();
+
+    for (const JsonShardedExporter::Shard& s : shards)
+    {
+      if (!s.document)
+        continue;
+
+      m_writer->beginObject();
+      m_writer->field("doctype", s.document->doctype);
+      m_writer->field("file", s.file);
+      m_writer->field("title", s.document->title);
+      m_writer->endObject();
+    }
+
+    m_writer->endArray();
+
+    m_writer->key("entities");
+    m_writer->beginArray();
+
+    for (const JsonShardedExporter::Shard& s : shards)
+    {
+      if (!s.entity)
+        continue;
+
+      m_writer->beginObject();
+      m_writer->field("file", s.file);
+      m_writer->field("kind", to_string(s.entity->kind()));
+      m_writer->field("name", model::path(*s.entity));
+      m_writer->field("path", entityPath(*s.entity));
+      m_writer->endObject();
+    }
+
+    m_writer->endArray();
+
+    if (!model.groups.groups.empty())
+    {
+      m_writer->key("groups");
+      m_writer->beginArray();
+
+      for (const auto& g : model.groups.groups)
+        writeGroup(*g);
+
+      m_writer->endArray();
+    }
+
+    if (model.program() && !model.program()->macros.empty())
+    {
+      m_writer->key("macros");
+      writeEntityArray(model.program()->macros);
+    }
+
+    if (model.program() && !model.program()->related.empty())
+    {
+      m_writer->key("related");
+      writeRelated(*model.program());
+    }
+
+    m_writer->endObject();
+    m_writer = nullptr;
+  }
+
+protected:
+  void writeEntity(Entity& e, const char* accessibility) override
+  {
+    auto it = &e != root ? files.find(&e) : files.end();
+
+    if (it == files.end())
+      return JsonStreamExporter::writeEntity(e, accessibility);
+
+    m_writer->beginObject();
+
+    if (accessibility)
+      m_writer->field("accessibility", accessibility);
+
+    m_writer->field("name", e.name.str());
+    m_writer->field("shard", it->second);
+    m_writer->field("type", to_string(e.kind()));
+
+    m_writer->endObject();
+  }
+};
+
+// Shard files are named after the path of their entity or document
+// (see model::path()), so that they do not change when other parts of the
+// model do: readable characters of the path followed by its hash.
+static std::string shard_file(const std::string& dir, const std::string& path, std::set<std::string>& files)
+{
+  std::string name;
+
+  for (size_t i(0); i < path.size() && name.size() < 64; ++i)
+  {
+    const char c = path.at(i);
+
+    if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-')
+    {
+      name.push_back(c);
+    }
+    else if (c == ':' && i + 1 < path.size() && path.at(i + 1) == ':')
+    {
+      if (!name.empty())
+        name.push_back('.');
+
+      ++i;
+    }
+    else
+    {
+      name.push_back('_');
+    }
+  }
+
+  if (name.empty())
+    name = "global";
+
+  char hash[17];
+  std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(model::hash(path)));
+
+  std::string result = dir + "/" + name + "-" + hash + ".json";
+
+  // objects sharing a path are numbered in model order
+  for (int n = 2; !files.insert(result).second; ++n)
+    result = dir + "/" + name + "-" + hash + "-" + std::to_string(n) + ".json";
+
+  return result;
+}
+
+static void list_entity_shards(const std::shared_ptr<Entity>& e, std::vector<JsonShardedExporter::Shard>& shards, std::set<std::string>& files)
+{
+  if (e->is<Namespace>())
+  {
+    shards.push_back({ e, nullptr, shard_file("entities", model::path(*e), files) });
+
+    for (const auto& child : static_cast<Namespace&>(*e).entities)
+      list_entity_shards(child, shards, files);
+  }
+  else if (e->is<Class>())
+  {
+    shards.push_back({ e, nullptr, shard_file("entities", model::path(*e), files) });
+
+    for (const auto& child : static_cast<Class&>(*e).members)
+      list_entity_shards(child, shards, files);
+  }
+}
+
+JsonShardedExporter::JsonShardedExporter(const Model& m, OutputSync& sync)
+  : model(m),
+    m_sync(sync)
+{
+
+}
+
+void JsonShardedExporter::setThreads(size_t n)
+{
+  m_threads = n;
+}
+
+void JsonShardedExporter::write()
+{
+  listShards();
+  writeShards();
+  writeManifest();
+  pruneShards();
+}
+
+const std::vector<JsonShardedExporter::Shard>& JsonShardedExporter::shards() const
+{
+  return m_shards;
+}
+
+void JsonShardedExporter::listShards()
+{
+  m_shards.clear();
+  std::set<std::string> files;
+
+  if (model.program())
+    list_entity_shards(model.program()->globalNamespace(), m_shards, files);
+
+  for (const auto& doc : model.documents)
+    m_shards.push_back({ nullptr, doc, shard_file("documents", model::path(*doc), files) });
+}
+
+static std::unordered_map<const Entity*, std::string> shard_files(const std::vector<JsonShardedExporter::Shard>& shards)
+{
+  std::unordered_map<const Entity*, std::string> result;
+
+  for (const JsonShardedExporter::Shard& s : shards)
+  {
+    if (s.entity)
+      result[s.entity.get()] = s.file;
+  }
+
+  return result;
+}
+
+void JsonShardedExporter::writeShards()
+{
+  if (m_shards.empty())
+    return;
+
+  const auto files = shard_files(m_shards);
+
+  size_t nb_threads = m_threads;
+
+  if (nb_threads == 0)
+    nb_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  nb_threads = std::min(nb_threads, m_shards.size());
+
+  std::atomic<size_t> next_shard{ 0 };
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  // shards only read the model, each thread has its own writer
+  auto work = [&]() {
+    JsonShardWriter writer{ model, files };
+
+    for (size_t i = next_shard++; i < m_shards.size(); i = next_shard++)
+    {
+      try
+      {
+        m_sync.stream(m_sync.directory() / m_shards.at(i).file, [&](OutputSink& out) {
+          writer.writeShard(m_shards.at(i), out);
+        });
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock{ error_mutex };
+
+        if (!error)
+          error = std::current_exception();
+
+        next_shard = m_shards.size();
+        return;
+      }
+    }
+  };
+
+  if (nb_threads == 1)
+  {
+    work();
+  }
+  else
+  {
+    std::vector<std::thread> workers;
+
+    for (size_t i(0); i < nb_threads; ++i)
+      workers.emplace_back(work);
+
+    for (std::thread& t : workers)
+      t.join();
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void JsonShardedExporter::pruneShards()
+{
+  // only the shards listed in the manifest were produced, the others
+  // come from a previous export (e.g. of a renamed entity)
+  m_sync.prune({ "entities", "documents" });
+}
+
+void JsonShardedExporter::writeManifest()
+{
+  const auto files = shard_files(m_shards);
+  JsonShardWriter writer{ model, files };
+
+  m_sync.stream(m_sync.directory() / "manifest.json", [&](OutputSink& out) {
+    writer.writeManifest(m_shards, out);
+  });
+}
+
+} // namespace dex
@@ -0,0 +1,66 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_JSON_SHARDS_H
+#define DEX_OUTPUT_JSON_SHARDS_H
+
+#include "dex/dex-output.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+class Document;
+class Entity;
+class Model;
+class OutputSync;
+
+// Writes the model as one JSON file per namespace, class and document
+// ("shards") and a manifest.json that lists them.
+// Inside a shard, the namespaces and classes that have their own shard
+// are replaced by { "name", "shard", "type" } objects (plus
+// "accessibility" for class members).
+// The manifest has the paths ("$.program...") of the entities, as in
+// dex.json, and the groups, macros and related non-members.
+// Shards that are not in the manifest are removed by write().
+class DEX_OUTPUT_API JsonShardedExporter
+{
+public:
+  const Model& model;
+
+public:
+  JsonShardedExporter(const Model& m, OutputSync& sync);
+
+  // 0 means one thread per core
+  void setThreads(size_t n);
+
+  void write();
+
+  struct Shard
+  {
+    std::shared_ptr<Entity> entity;
+    std::shared_ptr<Document> document;
+    std::string file;
+  };
+
+  const std::vector<Shard>& shards() const;
+
+protected:
+  void listShards();
+  void writeShards();
+  void writeManifest();
+  void pruneShards();
+
+private:
+  OutputSync& m_sync;
+  size_t m_threads = 0;
+  std::vector<Shard> m_shards;
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_JSON_SHARDS_H
@@ -0,0 +1,637 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/json/json-stream.h"
+
+#include "dex/output/json/json-export.h"
+#include "dex/output/output-sink.h"
+
+#include "dex/model/code-block.h"
+#include "dex/model/display-math.h"
+#include "dex/model/model.h"
+#include "dex/model/paragraph-annotations.h"
+#include "dex/model/since.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace dex
+{
+
+JsonTokenWriter::~JsonTokenWriter()
+{
+
+}
+
+JsonStreamWriter::JsonStreamWriter(OutputSink& out)
+  : m_out(out)
+{
+
+}
+
+void JsonStreamWriter::beginObject()
+{
+  beforeValue();
+  int indent = m_stack.empty() ? 0 : m_stack.back().indent + 2;
+  // '{' is written with the first key, an empty object is written as "{}"
+  m_stack.push_back(Frame{ true, true, indent, nullptr });
+}
+
+void JsonStreamWriter::endObject()
+{
+  assert(!m_stack.empty() && m_stack.back().is_object);
+
+  const Frame frame = m_stack.back();
+  m_stack.pop_back();
+
+  if (frame.empty)
+  {
+    m_out.write("{}", 2);
+  }
+  else
+  {
+    m_out.write('\n');
+    writeIndent(frame.indent);
+    m_out.write('}');
+  }
+}
+
+void JsonStreamWriter::beginArray()
+{
+  beforeValue();
+  int indent = m_stack.empty() ? 0 : m_stack.back().indent + 2;
+  m_out.write('[');
+  m_stack.push_back(Frame{ false, true, indent, nullptr });
+}
+
+void JsonStreamWriter::endArray()
+{
+  assert(!m_stack.empty() && !m_stack.back().is_object);
+
+  m_stack.pop_back();
+  m_out.write(']');
+}
+
+void JsonStreamWriter::key(const char* name)
+{
+  assert(!m_stack.empty() && m_stack.back().is_object);
+
+  Frame& frame = m_stack.back();
+
+  assert(frame.last_key == nullptr || std::strcmp(frame.last_key, name) < 0);
+  frame.last_key = name;
+
+  if (frame.empty)
+    m_out.write("{\n", 2);
+  else
+    m_out.write(",\n", 2);
+
+  frame.empty = false;
+
+  writeIndent(frame.indent + 2);
+  writeString(name, std::strlen(name));
+  m_out.write(": ", 2);
+}
+
+void JsonStreamWriter::value(const std::string& str)
+{
+  beforeValue();
+  writeString(str.data(), str.size());
+}
+
+void JsonStreamWriter::value(const char* str)
+{
+  beforeValue();
+  writeString(str, std::strlen(str));
+}
+
+void JsonStreamWriter::value(int n)
+{
+  beforeValue();
+  m_out.write(std::to_string(n));
+}
+
+void JsonStreamWriter::value(bool b)
+{
+  beforeValue();
+  m_out << (b ? "true" : "false");
+}
+
+void JsonStreamWriter::beforeValue()
+{
+  if (m_stack.empty() || m_stack.back().is_object)
+    return;
+
+  Frame& frame = m_stack.back();
+
+  if (!frame.empty)
+    m_out.write(", ", 2);
+
+  frame.empty = false;
+}
+
+void JsonStreamWriter::writeString(const char* str, size_t len)
+{
+  m_out.write('"');
+
+  const char* end = str + len;
+  const char* run = str;
+
+  // characters that need no escaping are forwarded in runs
+  for (const char* it = str; it != end; ++it)
+  {
+    const char* escaped = nullptr;
+
+    switch (*it)
+    {
+    case '"': escaped = "\\\""; break;
+    case '\\': escaped = "\\\\"; break;
+    case '\n': escaped = "\\n"; break;
+    case '\t': escaped = "\\t"; break;
+    case '\r': escaped = "\\r"; break;
+    case '\b': escaped = "\\b"; break;
+    case '\f': escaped = "\\f"; break;
+    default: continue;
+    }
+
+    m_out.write(run, it - run);
+    m_out.write(escaped, 2);
+    run = it + 1;
+  }
+
+  m_out.write(run, end - run);
+  m_out.write('"');
+}
+
+void JsonStreamWriter::writeIndent(int n)
+{
+  static const char spaces[] = "                                ";
+  constexpr int max = static_cast<int>(sizeof(spaces) - 1);
+
+  for (; n > max; n -= max)
+    m_out.write(spaces, max);
+
+  m_out.write(spaces, n);
+}
+
+JsonStreamExporter::JsonStreamExporter(const Model& m)
+  : model(m)
+{
+
+}
+
+JsonStreamExporter::~JsonStreamExporter()
+{
+
+}
+
+void JsonStreamExporter::write(const Model& m, OutputSink& out)
+{
+  JsonStreamExporter ex{ m };
+  ex.write(out);
+}
+
+void JsonStreamExporter::write(OutputSink& out)
+{
+  JsonStreamWriter writer{ out };
+  write(writer);
+}
+
+void JsonStreamExporter::write(JsonTokenWriter& writer)
+{
+  m_writer = &writer;
+
+  m_writer->beginObject();
+
+  if (!model.documents.empty())
+  {
+    m_writer->key("documents");
+    m_writer->beginArray();
+
+    for (const auto& doc : model.documents)
+      writeDocument(*doc);
+
+    m_writer->endArray();
+  }
+
+  if (!model.groups.groups.empty())
+  {
+    m_writer->key("groups");
+    m_writer->beginArray();
+
+    for (const auto& g : model.groups.groups)
+      writeGroup(*g);
+
+    m_writer->endArray();
+  }
+
+  if (model.program())
+  {
+    m_writer->key("program");
+    writeProgram(*model.program());
+  }
+
+  m_writer->endObject();
+
+  m_writer = nullptr;
+}
+
+void JsonStreamExporter::writeProgram(Program& prog)
+{
+  m_writer->beginObject();
+
+  m_writer->key("global_namespace");
+  writeEntity(*prog.globalNamespace());
+
+  if (!prog.macros.empty())
+  {
+    m_writer->key("macros");
+    writeEntityArray(prog.macros);
+  }
+
+  if (!prog.related.empty())
+  {
+    m_writer->key("related");
+    writeRelated(prog);
+  }
+
+  m_writer->endObject();
+}
+
+void JsonStreamExporter::writeRelated(Program& prog)
+{
+  m_writer->beginArray();
+
+  for (const auto& e : prog.related.class_map)
+  {
+    m_writer->beginObject();
+    m_writer->field("class", entityPath(*e.second->the_class));
+
+    m_writer->key("functions");
+    m_writer->beginArray();
+
+    for (const auto& f : e.second->non_members)
+      m_writer->value(entityPath(*f));
+
+    m_writer->endArray();
+    m_writer->endObject();
+  }
+
+  m_writer->endArray();
+}
+
+// fields are written in the order of their names, see JsonProgramSerializer
+// for the equivalent per-kind visitor
+void JsonStreamExporter::writeEntity(Entity& e, const char* accessibility)
+{
+  m_writer->beginObject();
+
+  if (accessibility)
+    m_writer->field("accessibility", accessibility);
+
+  if (e.is<FunctionParameter>() && static_cast<FunctionParameter&>(e).default_value != dex::Expression())
+    m_writer->field("default_value", static_cast<FunctionParameter&>(e).default_value);
+  else if (e.is<Variable>() && static_cast<Variable&>(e).defaultValue() != dex::Expression())
+    m_writer->field("default_value", static_cast<Variable&>(e).defaultValue());
+
+  m_writer->key("documentation");
+
+  if (e.is<FunctionParameter>() && e.brief.has_value())
+    m_writer->value(e.brief.value());
+  else
+    writeDocumentation(e);
+
+  if (e.is<Namespace>() && !static_cast<Namespace&>(e).entities.empty())
+  {
+    m_writer->key("entities");
+    writeEntityArray(static_cast<Namespace&>(e).entities);
+  }
+
+  if (!model.groups.groupsOf(e).empty())
+  {
+    m_writer->key("groups");
+    writeGroupPaths(model.groups.groupsOf(e));
+  }
+
+  if (e.is<Class>() && !static_cast<Class&>(e).members.empty())
+  {
+    m_writer->key("members");
+    m_writer->beginArray();
+
+    for (const auto& m : static_cast<Class&>(e).members)
+      writeEntity(*m, to_string(m->getAccessSpecifier()).c_str());
+
+    m_writer->endArray();
+  }
+
+  m_writer->field("name", e.name.str());
+
+  if (e.is<Function>() && !static_cast<Function&>(e).parameters.empty())
+  {
+    m_writer->key("parameters");
+    writeEntityArray(static_cast<Function&>(e).parameters);
+  }
+  else if (e.is<Macro>())
+  {
+    m_writer->key("parameters");
+    m_writer->beginArray();
+
+    for (const std::string& p : static_cast<Macro&>(e).parameters)
+      m_writer->value(p);
+
+    m_writer->endArray();
+  }
+
+  if (e.is<Function>())
+  {
+    const auto& f = static_cast<Function&>(e);
+
+    m_writer->field("return_type", f.return_type.type.str());
+
+    if (f.specifiers != 0)
+      m_writer->field("specifiers", f.specifiersList());
+  }
+  else if (e.is<Variable>() && static_cast<Variable&>(e).specifiers() != 0)
+  {
+    const auto& v = static_cast<Variable&>(e);
+    std::string specifiers;
+
+    if (v.specifiers() & dex::VariableSpecifier::Inline)
+      specifiers += "inline,";
+    if (v.specifiers() & dex::VariableSpecifier::Static)
+      specifiers += "static,";
+    if (v.specifiers() & dex::VariableSpecifier::Constexpr)
+      specifiers += "constexpr,";
+
+    specifiers.pop_back();
+
+    m_writer->field("specifiers", specifiers);
+  }
+
+  if (e.is<FunctionParameter>())
+    m_writer->field("type", static_cast<FunctionParameter&>(e).type.str());
+  else
+    m_writer->field("type", to_string(e.kind()));
+
+  if (e.is<Typedef>())
+    m_writer->field("typedef", static_cast<Typedef&>(e).type.str());
+
+  if (e.is<EnumValue>() && !static_cast<EnumValue&>(e).value().empty())
+    m_writer->field("value", static_cast<EnumValue&>(e).value());
+
+  if (e.is<Enum>())
+  {
+    m_writer->key("values");
+    writeEntityArray(static_cast<Enum&>(e).values);
+  }
+
+  if (e.is<Variable>())
+    m_writer->field("vartype", static_cast<Variable&>(e).type().str());
+
+  m_writer->endObject();
+}
+
+void JsonStreamExporter::writeDocumentation(Entity& e)
+{
+  m_writer->beginObject();
+
+  if (e.brief.has_value())
+    m_writer->field("brief", e.brief.value());
+
+  if (e.description && !e.description->childNodes().empty())
+  {
+    m_writer->key("description");
+    writeNodeArray(e.description->childNodes());
+  }
+
+  if (e.is<Function>() && static_cast<Function&>(e).return_type.brief.has_value())
+    m_writer->field("returns", static_cast<Function&>(e).return_type.brief.value());
+
+  if (e.since.has_value())
+    m_writer->field("since", e.since.value().version());
+
+  m_writer->endObject();
+}
+
+void JsonStreamExporter::writeGroupPaths(const std::vector<std::shared_ptr<Group>>& groups)
+{
+  m_writer->beginArray();
+
+  for (const auto& g : groups)
+    m_writer->value("$.groups[" + std::to_string(g->index) + "]");
+
+  m_writer->endArray();
+}
+
+void JsonStreamExporter::writeDocument(Document& doc)
+{
+  m_writer->beginObject();
+
+  m_writer->key("content");
+  writeNodeArray(doc.childNodes());
+
+  m_writer->field("doctype", doc.doctype);
+
+  if (!model.groups.groupsOf(doc).empty())
+  {
+    m_writer->key("groups");
+    writeGroupPaths(model.groups.groupsOf(doc));
+  }
+
+  m_writer->field("title", doc.title);
+  m_writer->field("type", doc.className());
+
+  m_writer->endObject();
+}
+
+// see JsonDocumentSerializer
+void JsonStreamExporter::writeNode(DocumentNode& node)
+{
+  m_writer->beginObject();
+
+  if (node.is<Image>())
+  {
+    const auto& img = static_cast<Image&>(node);
+
+    if (img.height != -1)
+      m_writer->field("height", img.height);
+
+    m_writer->field("src", img.src);
+    m_writer->field("type", node.className());
+
+    if (img.width != -1)
+      m_writer->field("width", img.width);
+  }
+  else if (node.is<List>())
+  {
+    const auto& l = static_cast<List&>(node);
+
+    m_writer->key("items");
+    writeNodeArray(l.childNodes());
+
+    if (!l.marker.empty())
+      m_writer->field("marker", l.marker);
+
+    m_writer->field("ordered", l.ordered);
+
+    if (l.ordered)
+      m_writer->field("reversed", l.reversed);
+
+    m_writer->field("type", node.className());
+  }
+  else if (node.is<ListItem>())
+  {
+    const auto& li = static_cast<ListItem&>(node);
+
+    m_writer->key("content");
+    writeNodeArray(li.childNodes());
+
+    if (!li.marker.empty())
+      m_writer->field("marker", li.marker);
+
+    m_writer->field("type", node.className());
+
+    if (li.value != -1)
+      m_writer->field("value", li.value);
+  }
+  else if (node.is<Paragraph>())
+  {
+    const auto& par = static_cast<Paragraph&>(node);
+
+    if (!par.metadata().empty())
+    {
+      m_writer->key("metadata");
+      m_writer->beginArray();
+
+      for (const auto& md : par.metadata())
+        writeMetadata(*md);
+
+      m_writer->endArray();
+    }
+
+    m_writer->field("text", par.text());
+    m_writer->field("type", node.className());
+  }
+  else if (node.is<BeginSince>())
+  {
+    m_writer->field("type", node.className());
+    m_writer->field("version", static_cast<BeginSince&>(node).version);
+  }
+  else if (node.is<EndSince>())
+  {
+    m_writer->field("type", node.className());
+    m_writer->field("version", static_cast<EndSince&>(node).beginsince.lock()->version);
+  }
+  else if (node.is<DisplayMath>())
+  {
+    m_writer->field("source", static_cast<DisplayMath&>(node).source);
+    m_writer->field("type", node.className());
+  }
+  else if (node.is<GroupTable>())
+  {
+    m_writer->field("groupname", static_cast<GroupTable&>(node).groupname);
+    m_writer->field("type", node.className());
+  }
+  else if (node.is<CodeBlock>())
+  {
+    m_writer->field("code", static_cast<CodeBlock&>(node).code);
+    m_writer->field("lang", static_cast<CodeBlock&>(node).lang);
+    m_writer->field("type", node.className());
+  }
+  else if (node.is<Sectioning>())
+  {
+    const auto& sec = static_cast<Sectioning&>(node);
+
+    m_writer->key("content");
+    writeNodeArray(sec.childNodes());
+
+    m_writer->field("depth", Sectioning::depth2str(sec.depth));
+    m_writer->field("name", sec.name);
+    m_writer->field("type", node.className());
+  }
+  else
+  {
+    m_writer->field("type", node.className());
+  }
+
+  m_writer->endObject();
+}
+
+void JsonStreamExporter::writeNodeArray(const std::vector<std::shared_ptr<DocumentNode>>& nodes)
+{
+  m_writer->beginArray();
+
+  for (const auto& n : nodes)
+    writeNode(*n);
+
+  m_writer->endArray();
+}
+
+void JsonStreamExporter::writeMetadata(const ParagraphMetaData& pmd)
+{
+  m_writer->beginObject();
+
+  m_writer->field("begin", static_cast<int>(pmd.range().begin()));
+  m_writer->field("end", static_cast<int>(pmd.range().end()));
+
+  if (pmd.is<ParIndexEntry>())
+    m_writer->field("key", pmd.get<ParIndexEntry>().key);
+  else if (pmd.is<TextStyle>())
+    m_writer->field("style", static_cast<const TextStyle&>(pmd).style());
+
+  m_writer->field("type", pmd.className());
+
+  if (pmd.is<Link>())
+    m_writer->field("url", static_cast<const Link&>(pmd).url());
+  else if (pmd.is<Since>())
+    m_writer->field("version", pmd.get<Since>().version());
+
+  m_writer->endObject();
+}
+
+void JsonStreamExporter::writeGroup(const Group& group)
+{
+  m_writer->beginObject();
+
+  m_writer->key("documents");
+  m_writer->beginArray();
+
+  for (const auto& d : group.content.documents)
+  {
+    auto it = std::find(model.documents.begin(), model.documents.end(), d);
+    m_writer->value("$.documents[" + std::to_string(std::distance(model.documents.begin(), it)) + "]");
+  }
+
+  m_writer->endArray();
+
+  m_writer->key("entities");
+  m_writer->beginArray();
+
+  for (const auto& e : group.content.entities)
+    m_writer->value(entityPath(*e));
+
+  m_writer->endArray();
+
+  m_writer->field("name", group.name);
+
+  m_writer->endObject();
+}
+
+const std::string& JsonStreamExporter::entityPath(Entity& e) const
+{
+  // groups are written before the program, so the paths cannot be
+  // recorded while the entities are written
+  if (m_paths.empty())
+    JsonProgramSerializer::computePaths(*model.program(), m_paths);
+
+  auto it = m_paths.find(&e);
+
+  if (it == m_paths.end())
+    it = m_paths.emplace(&e, JsonProgramSerializer::path(e, *model.program())).first;
+
+  return it->second;
+}
+
+} // namespace dex
@@ -0,0 +1,142 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_JSON_STREAM_H
+#define DEX_OUTPUT_JSON_STREAM_H
+
+#include "dex/dex-output.h"
+
+#include "dex/output/json/json-export.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+class Document;
+class DocumentNode;
+class Entity;
+class Group;
+class Model;
+class OutputSink;
+class ParagraphMetaData;
+class Program;
+
+// Receives the values of a JSON document, in document order.
+class DEX_OUTPUT_API JsonTokenWriter
+{
+public:
+  virtual ~JsonTokenWriter();
+
+  virtual void beginObject() = 0;
+  virtual void endObject() = 0;
+  virtual void beginArray() = 0;
+  virtual void endArray() = 0;
+
+  virtual void key(const char* name) = 0;
+
+  virtual void value(const std::string& str) = 0;
+  virtual void value(const char* str) = 0;
+  virtual void value(int n) = 0;
+  virtual void value(bool b) = 0;
+
+  template<typename T>
+  void field(const char* name, const T& val)
+  {
+    key(name);
+    value(val);
+  }
+};
+
+// Writes JSON tokens to a sink, with the same layout as json::stringify().
+// Object keys must be written in increasing order, as json::Object
+// stores them sorted.
+class DEX_OUTPUT_API JsonStreamWriter : public JsonTokenWriter
+{
+public:
+  explicit JsonStreamWriter(OutputSink& out);
+
+  void beginObject() override;
+  void endObject() override;
+  void beginArray() override;
+  void endArray() override;
+
+  void key(const char* name) override;
+
+  void value(const std::string& str) override;
+  void value(const char* str) override;
+  void value(int n) override;
+  void value(bool b) override;
+
+protected:
+  void beforeValue();
+  void writeString(const char* str, size_t len);
+  void writeIndent(int n);
+
+private:
+  struct Frame
+  {
+    bool is_object;
+    bool empty;
+    int indent;
+    const char* last_key;
+  };
+
+  OutputSink& m_out;
+  std::vector<Frame> m_stack;
+};
+
+// Streaming counterpart of JsonExporter, the model is written without
+// building a json::Object.
+// The output is byte-identical to json::stringify(JsonExporter::serialize(model)).
+class DEX_OUTPUT_API JsonStreamExporter
+{
+public:
+  const Model& model;
+
+public:
+  explicit JsonStreamExporter(const Model& m);
+  virtual ~JsonStreamExporter();
+
+  static void write(const Model& model, OutputSink& out);
+  void write(OutputSink& out);
+  void write(JsonTokenWriter& writer);
+
+protected:
+  void writeProgram(Program& prog);
+  virtual void writeEntity(Entity& e, const char* accessibility = nullptr);
+  void writeDocumentation(Entity& e);
+  void writeGroupPaths(const std::vector<std::shared_ptr<Group>>& groups);
+  void writeDocument(Document& doc);
+  void writeNode(DocumentNode& node);
+  void writeNodeArray(const std::vector<std::shared_ptr<DocumentNode>>& nodes);
+  void writeMetadata(const ParagraphMetaData& pmd);
+  void writeGroup(const Group& group);
+  void writeRelated(Program& prog);
+
+  const std::string& entityPath(Entity& e) const;
+
+  template<typename T>
+  void writeEntityArray(const std::vector<std::shared_ptr<T>>& entities)
+  {
+    m_writer->beginArray();
+
+    for (const auto& e : entities)
+      writeEntity(static_cast<Entity&>(*e));
+
+    m_writer->endArray();
+  }
+
+protected:
+  JsonTokenWriter* m_writer = nullptr;
+
+private:
+  mutable JsonPathMap m_paths; // computed on first use
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_JSON_STREAM_H
@@ -4,6 +4,7 @@
 
 #include "dex/output/liquid/latex-export.h"
 
+#include "dex/output/output-sink.h"
 #include "dex/output/paragraph-converter.h"
 
 #include "dex/model/code-block.h"
@@ -78,23 +79,23 @@ LatexStringifier::LatexStringifier(LiquidExporter& exp)
 
 }
 
-std::string LatexStringifier::stringify_list(const dex::List& list) const
+void LatexStringifier::write_list(const dex::List& list, OutputSink& out) const
 {
-  std::string result = "\\begin{itemize}\n";
+  out << "\\begin{itemize}\n";
 
   for (const auto& li : list.items)
   {
-    result += "  \\item " + stringify_listitem(static_cast<dex::ListItem&>(*li)) + "\n";
+    out << "  \\item ";
+    write_listitem(static_cast<dex::ListItem&>(*li), out);
+    out << "\n";
   }
 
-  result += "\\end{itemize}";
-
-  return result;
+  out << "\\end{itemize}";
 }
 
-std::string LatexStringifier::stringify_listitem(const dex::ListItem& li) const
+void LatexStringifier::write_listitem(const dex::ListItem& li, OutputSink& out) const
 {
-  return stringify_domcontent(li.content);
+  write_domcontent(li.content, out);
 }
 
 std::string LatexStringifier::stringify_paragraph(const dex::Paragraph& par) const
@@ -190,34 +191,31 @@ std::string LatexStringifier::stringify_backmatter(const dex::BackMatter& bm) co
   return "\\backmatter";
 }
 
-std::string LatexStringifier::stringify_section(const dex::Sectioning& sec) const
+void LatexStringifier::write_section(const dex::Sectioning& sec, OutputSink& out) const
 {
-  std::string result;
-
   switch (sec.depth)
   {
   case dex::Sectioning::Part:
-    result += "\\part{";
+    out << "\\part{";
     break;
   case dex::Sectioning::Chapter:
-    result += "\\chapter{";
+    out << "\\chapter{";
     break;
   case dex::Sectioning::Section:
-    result += "\\section{";
+    out << "\\section{";
     break;
   default:
-    result += "{";
+    out << "{";
     break;
   }
 
-  result += sec.name + "}\n\n";
+  out << sec.name << "}\n\n";
 
   for (const auto& c : sec.content)
   {
-    result += stringify_domnode(*c) + "\n\n";
+    write_domnode(*c, out);
+    out << "\n\n";
   }
-
-  return result;
 }
 
 std::string LatexStringifier::stringify_tableofcontents(const dex::TableOfContents& toc) const
@@ -10,17 +10,34 @@
 #include "dex/output/liquid/markdown-export.h"
 #include "dex/output/liquid/latex-export.h"
 #include "dex/output/config.h"
+#include "dex/output/output-queue.h"
+#include "dex/output/output-sink.h"
+#include "dex/output/output-sync.h"
+#include "dex/output/search-index.h"
 
+#include "dex/app/version.h"
 #include "dex/model/model.h"
+#include "dex/model/model-diff.h"
+#include "dex/model/model-snapshot.h"
+#include "dex/model/model-visitor.h"
 
 #include "dex/common/errors.h"
 #include "dex/common/file-utils.h"
+#include "dex/common/logging.h"
 #include "dex/common/string-utils.h"
 
+#include <json-toolkit/stringify.h>
+
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <atomic>
 #include <fstream>
+#include <mutex>
 #include <set>
+#include <thread>
 
 
 namespace dex
@@ -98,6 +115,61 @@ TemplateWithFrontMatter open_template_with_front_matter(const std::filesystem::p
   return result;
 }
 
+static std::map<std::string, std::shared_ptr<LiquidStringifier>> create_stringifiers(LiquidExporter& exporter)
+{
+  std::map<std::string, std::shared_ptr<LiquidStringifier>> result;
+  result["md"] = std::make_shared<MarkdownStringifier>(exporter);
+  result["tex"] = std::make_shared<LatexStringifier>(exporter);
+  return result;
+}
+
+// Renders pages on behalf of a LiquidExporter.
+// Each worker thread has its own renderer so that the liquid rendering
+// state and the selected stringifier are not shared; the exporter, the
+// model and the templates are only read.
+class LiquidPageRenderer : public liquid::Renderer
+{
+public:
+  LiquidExporter& exporter;
+
+public:
+  explicit LiquidPageRenderer(LiquidExporter& exp)
+    : exporter(exp),
+      m_stringifiers(create_stringifiers(exp))
+  {
+    templates() = exp.templates();
+  }
+
+  void renderPage(const LiquidExporter::PageJob& job)
+  {
+    m_stringifier = m_stringifiers[job.layout->filesuffix];
+    m_stringifier->selected();
+
+    liquid::Map context = exporter.pageContext({ { job.field, to_liquid(job.object) }, { "url", job.url } });
+
+    std::string output = liquid::Renderer::render(job.layout->model, context);
+
+    exporter.postProcess(output);
+
+    exporter.write(std::move(output), exporter.outputPath() + "/" + job.url);
+  }
+
+protected:
+  std::string stringify(const liquid::Value& val) override
+  {
+    return m_stringifier->stringify(val);
+  }
+
+  liquid::Value applyFilter(const std::string& name, const liquid::Value& object, const std::vector<liquid::Value>& args) override
+  {
+    return exporter.m_filters->apply(name, object, args);
+  }
+
+private:
+  std::map<std::string, std::shared_ptr<LiquidStringifier>> m_stringifiers;
+  std::shared_ptr<LiquidStringifier> m_stringifier;
+};
+
 class LiquidExporterModelVisitor : public ProgramVisitor
 {
 public:
@@ -111,7 +183,10 @@ public:
   void visitModel(const dex::Model& model)
   {
     for (auto d : model.documents)
+    {
+      exporter.index(*d);
       visit_document(*d);
+    }
 
     if (model.program())
     {
@@ -119,11 +194,16 @@ public:
     }
   }
 
+  void visit(dex::Entity& e) override
+  {
+    exporter.index(e);
+    ProgramVisitor::visit(e);
+  }
+
   void visit(dex::Class& cla) override
   {
     if (!exporter.layouts().class_template.model.nodes().empty())
     {
-      exporter.selectStringifier(exporter.layouts().class_template.filesuffix);
       exporter.dump(cla);
     }
 
@@ -134,19 +214,19 @@ public:
   {
     if (!exporter.layouts().namespace_template.model.nodes().empty())
     {
-      exporter.selectStringifier(exporter.layouts().namespace_template.filesuffix);
       exporter.dump(ns);
     }
 
     ProgramVisitor::visit(ns);
   }
 
-  void visit(dex::Enum& /* enm */) override
+  void visit(dex::Enum& enm) override
   {
     // @TODO: one page per enum ?
 
-    // do not visit enum values
-    // ProgramVisitor::visit(enm);
+    // do not visit enum values, they are only indexed
+    for (const auto& value : enm.values)
+      exporter.index(*value);
   }
 
   void visit(dex::Function& /* fn */) override
@@ -161,7 +241,6 @@ public:
   {
     if (!exporter.layouts().document_template.model.nodes().empty())
     {
-      exporter.selectStringifier(exporter.layouts().document_template.filesuffix);
       exporter.dump(doc);
     }
   }
@@ -171,8 +250,7 @@ LiquidExporter::LiquidExporter(std::string folder_path, const json::Json config)
   : m_folder_path(std::move(folder_path)),
     m_config(config)
 {
-  m_stringifiers["md"] = std::make_shared<MarkdownStringifier>(*this);
-  m_stringifiers["tex"] = std::make_shared<LatexStringifier>(*this);
+  m_stringifiers = create_stringifiers(*this);
 
   m_filters = std::make_unique<LiquidFilters>(*this);
 
@@ -183,8 +261,8 @@ LiquidExporter::LiquidExporter(std::string folder_path, const json::Json config)
     m_config = dex::read_output_config(m_folder_path + "/_config.yml");
   }
 
-  listLayouts();
   listIncludes();
+  listLayouts();
 }
 
 LiquidExporter::~LiquidExporter()
@@ -215,11 +293,13 @@ const LiquidExporter::Layouts& LiquidExporter::layouts() const
 void LiquidExporter::setVariables(const json::Object& obj)
 {
   setVariables(json_to_liquid(obj).toMap());
+  m_variables_signature = json::stringify(obj);
 }
 
 void LiquidExporter::setVariables(liquid::Map obj)
 {
   m_user_variables = obj;
+  m_variables_signature.clear();
 }
 
 const liquid::Map& LiquidExporter::variables() const
@@ -232,17 +312,97 @@ void LiquidExporter::render()
   if (model()->empty())
     return;
 
-  if (std::filesystem::exists(outputDir()))
-    std::filesystem::remove_all(outputDir());
+  LiquidValueCache cache;
+
+  // stringifier options and the base context depend on the user variables,
+  // they are resolved once for all pages
+  m_stringifiers = create_stringifiers(*this);
+  setupBaseContext();
+
+  // files are only rewritten if their content changed, files that are
+  // no longer produced are removed at the end
+  OutputSync sync{ outputDir() };
+
+  {
+    const std::string mode = dex::config::read(m_config, "assets", "copy").toString();
+
+    if (mode == "hardlink")
+      sync.setCopyMode(OutputSync::Hardlink);
+    else if (mode == "reflink")
+      sync.setCopyMode(OutputSync::Reflink);
+    else if (mode != "copy")
+      log::warning() << "unknown 'assets' mode " << mode << ", files will be copied";
+  }
+
+  // pages are written in the background while the next ones are rendered;
+  // if rendering throws, the queue is closed before the sync is destroyed
+  OutputQueue output_queue{ sync };
+
+  struct OutputGuard
+  {
+    LiquidExporter& exporter;
+
+    ~OutputGuard()
+    {
+      exporter.m_output_queue = nullptr;
+      exporter.m_sync = nullptr;
+    }
+  };
+
+  m_sync = &sync;
+  m_output_queue = &output_queue;
+  OutputGuard output_guard{ *this };
+
+  const bool incremental = dex::config::read(m_config, "incremental", false).toBool();
+  CacheSignature signature;
+  std::shared_ptr<Model> previous;
+
+  if (incremental)
+  {
+    previous = readCache(signature);
+  }
+  else
+  {
+    // pages rendered now are not described by the cached model
+    std::error_code ec;
+    std::filesystem::remove(cacheDir() / "model", ec);
+  }
+
+  if (previous)
+    selectDirtyPages(*previous);
+  else
+    m_dirty_pages.reset();
+
+  // the search index is filled while the pages are listed
+  m_search_index.reset();
+
+  if (dex::config::read(m_config, "search_index", false).toBool())
+  {
+    auto url = [this](const model::Object& obj) -> std::string {
+      if (obj.isProgramEntity())
+        return get_url(static_cast<const dex::Entity&>(obj));
+      else if (obj.isDocument())
+        return get_url(static_cast<const dex::Document&>(obj));
+      else
+        return {};
+    };
+
+    m_search_index = std::make_unique<SearchIndex::Builder>(*model(), url);
+  }
 
   LiquidExporterModelVisitor visitor{ *this, };
   visitor.visitModel(*model());
 
+  renderPages();
+
+  if (m_search_index)
+    writeSearchIndex();
+
   std::filesystem::directory_iterator diriterator{ folderPath() };
 
   for (const std::filesystem::directory_entry& entry : diriterator)
   {
-    if (dex::StdStringCRef(entry.path().filename().string()).starts_with("_"))
+    if (dex::StdStringCRef(entry.path().filename().string()).starts_with("_") || entry.path() == cacheDir())
       continue;
 
     if (entry.is_directory())
@@ -254,6 +414,13 @@ void LiquidExporter::render()
       renderFile(entry.path());
     }
   }
+
+  output_queue.close();
+
+  if (incremental)
+    writeCache(signature);
+
+  log_summary(sync.finish());
 }
 
 std::string LiquidExporter::get_url(const dex::Entity& e) const
@@ -296,16 +463,14 @@ void LiquidExporter::dump(const std::shared_ptr<model::Object>& obj, const char*
   if (url.empty())
     return;
 
-  liquid::Map context;
-  setupContext(context);
-  context[obj_field_name] = to_liquid(obj);
-  context["url"] = url;
-
-  std::string output = liquid::Renderer::render(layout.model, context);
-
-  postProcess(output);
+  // a page that did not change is still rendered if its file was removed
+  if (!isDirty(*obj) && std::filesystem::exists(outputDir() / url))
+  {
+    m_sync->keep(outputDir() / url);
+    return;
+  }
 
-  write(output, outputPath() + "/" + url);
+  m_pages.push_back(PageJob{ obj, obj_field_name, &layout, url });
 }
 
 void LiquidExporter::dump(dex::Class& cla)
@@ -323,6 +488,103 @@ void LiquidExporter::dump(dex::Document& doc)
   dump(doc.shared_from_this(), "document", m_layouts.document_template);
 }
 
+void LiquidExporter::renderPages()
+{
+  if (m_pages.empty())
+    return;
+
+  size_t nb_threads = static_cast<size_t>(dex::config::read(m_config, "threads", 0).toInt());
+
+  if (nb_threads == 0)
+    nb_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  nb_threads = std::min(nb_threads, m_pages.size());
+
+  std::vector<std::unique_ptr<LiquidPageRenderer>> renderers;
+
+  for (size_t i(0); i < nb_threads; ++i)
+    renderers.push_back(std::make_unique<LiquidPageRenderer>(*this));
+
+  std::atomic<size_t> next_page{ 0 };
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  // the workers share the cache of the exporting thread
+  LiquidValueCache* cache = LiquidValueCache::current();
+
+  auto work = [&](LiquidPageRenderer& renderer) {
+    LiquidValueCache::Scope cache_scope{ cache };
+
+    for (size_t i = next_page++; i < m_pages.size(); i = next_page++)
+    {
+      try
+      {
+        renderer.renderPage(m_pages.at(i));
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock{ error_mutex };
+
+        if (!error)
+          error = std::current_exception();
+
+        next_page = m_pages.size();
+        return;
+      }
+    }
+  };
+
+  if (nb_threads == 1)
+  {
+    work(*renderers.front());
+  }
+  else
+  {
+    std::vector<std::thread> workers;
+
+    for (const auto& r : renderers)
+      workers.emplace_back(work, std::ref(*r));
+
+    for (std::thread& t : workers)
+      t.join();
+  }
+
+  m_pages.clear();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void LiquidExporter::index(const dex::Entity& e)
+{
+  if (m_search_index)
+    m_search_index->add(e);
+}
+
+void LiquidExporter::index(const dex::Document& doc)
+{
+  if (m_search_index)
+    m_search_index->add(doc);
+}
+
+void LiquidExporter::writeSearchIndex()
+{
+  const size_t nb_threads = static_cast<size_t>(dex::config::read(m_config, "threads", 0).toInt());
+  SearchIndex index = m_search_index->build(nb_threads);
+  m_search_index.reset();
+
+  std::string data;
+  StringSink sink{ data };
+  index.write(sink);
+
+  write(std::move(data), outputDir() / "search-index.json");
+}
+
+LiquidFilters& LiquidExporter::filters() const
+{
+  return *m_filters;
+}
+
 void LiquidExporter::setModel(std::shared_ptr<Model> model)
 {
   m_model = model;
@@ -358,8 +620,9 @@ void LiquidExporter::listLayouts()
 LiquidLayout LiquidExporter::parseLayout(const std::filesystem::path& fileinfo, const std::string& name, std::string default_out)
 {
   LiquidLayout result;
-  std::string path = fileinfo.string();
-  result.model = open_liquid_template(path);
+  std::string source = file_utils::read_all(fileinfo);
+  loadIncludes(source);
+  result.model = liquid::parse(source);
   result.model.skipWhitespacesAfterTag();
   result.outdir = dex::config::read(m_config["output"], name, std::move(default_out)).toString();
   result.filesuffix = fileinfo.extension().string();
@@ -380,11 +643,80 @@ void LiquidExporter::listIncludes()
   for (const std::filesystem::directory_entry& entry : diriterator)
   {
     std::filesystem::path p = entry.path();
-    liquid::Template tmplt = open_liquid_template(p);
-    tmplt.skipWhitespacesAfterTag();
     std::string p_str = p.string();
     p_str.erase(p_str.begin(), p_str.begin() + folderPath().size() + 11);
-    templates()[p_str] = std::move(tmplt);
+    m_include_files[p_str] = p;
+  }
+}
+
+// returns the names of the templates included by a template,
+// or nothing if one of them is only known at render time
+static std::optional<std::vector<std::string>> list_includes(const std::string& source)
+{
+  std::vector<std::string> result;
+
+  for (size_t pos = source.find("{%"); pos != std::string::npos; pos = source.find("{%", pos + 2))
+  {
+    size_t i = pos + 2;
+
+    if (i < source.size() && source.at(i) == '-')
+      ++i;
+
+    while (i < source.size() && std::isspace(static_cast<unsigned char>(source.at(i))))
+      ++i;
+
+    if (source.compare(i, 8, "include ") != 0)
+      continue;
+
+    i += 8;
+
+    while (i < source.size() && std::isspace(static_cast<unsigned char>(source.at(i))))
+      ++i;
+
+    size_t end = i;
+
+    while (end < source.size() && !std::isspace(static_cast<unsigned char>(source.at(end))) && source.at(end) != '%')
+      ++end;
+
+    std::string name = source.substr(i, end - i);
+
+    if (name.size() >= 2 && (name.front() == '"' || name.front() == '\'') && name.back() == name.front())
+      name = name.substr(1, name.size() - 2);
+    else if (name.find_first_of("{}") != std::string::npos)
+      return std::nullopt;
+
+    result.push_back(name);
+  }
+
+  return result;
+}
+
+void LiquidExporter::loadIncludes(const std::string& source)
+{
+  std::optional<std::vector<std::string>> names = list_includes(source);
+
+  if (!names.has_value())
+  {
+    names = std::vector<std::string>();
+
+    for (const auto& entry : m_include_files)
+      names->push_back(entry.first);
+  }
+
+  for (const std::string& name : *names)
+  {
+    auto it = m_include_files.find(name);
+
+    // each include is parsed once, the first time it is referenced
+    if (it == m_include_files.end() || templates().find(name) != templates().end())
+      continue;
+
+    std::string include_source = file_utils::read_all(it->second);
+    liquid::Template tmplt = liquid::parse(include_source);
+    tmplt.skipWhitespacesAfterTag();
+    templates()[name] = std::move(tmplt);
+
+    loadIncludes(include_source);
   }
 }
 
@@ -406,18 +738,17 @@ void LiquidExporter::renderFile(const std::filesystem::path& filepath)
 
   if (!isSpecialFile(filepath))
   {
-    checkWriteDirectory(destpath.string());
-    std::filesystem::copy_file(filepath, destpath);
+    m_sync->copy(filepath, destpath);
     return;
   }
   
   TemplateWithFrontMatter tmplt = open_template_with_front_matter(filepath);
   tmplt.model.skipWhitespacesAfterTag();
+  loadIncludes(file_utils::read_all(filepath));
 
   // @TODO: use tmplt.frontmatter
 
-  liquid::Map context;
-  setupContext(context);
+  liquid::Map context = pageContext({});
 
   selectStringifier(filepath.extension().string().substr(1));
 
@@ -425,7 +756,7 @@ void LiquidExporter::renderFile(const std::filesystem::path& filepath)
 
   postProcess(output);
 
-  write(output, destpath);
+  write(std::move(output), destpath);
 }
 
 bool LiquidExporter::isSpecialFile(const std::filesystem::path& fileinfo) const
@@ -450,43 +781,373 @@ void LiquidExporter::selectStringifier(const std::string& filesuffix)
   m_stringifier->selected();
 }
 
-void LiquidExporter::setupContext(liquid::Map& context)
+void LiquidExporter::setupBaseContext()
 {
+  liquid::Map context;
   context["model"] = to_liquid(m_model);
 
   for (const std::string& pname : m_user_variables.propertyNames())
   {
     context[pname] = m_user_variables.property(pname);
   }
+
+  m_base_context = context;
 }
 
-void LiquidExporter::postProcess(std::string& output)
+liquid::Map LiquidExporter::pageContext(std::map<std::string, liquid::Value> variables) const
 {
-  LiquidExporter::trim_right(output);
-  LiquidExporter::simplify_empty_lines(output);
+  return liquid::Value(std::make_shared<LiquidContextOverlay>(m_base_context, std::move(variables))).toMap();
 }
 
-void LiquidExporter::checkWriteDirectory(const std::filesystem::path& filepath)
+// Writes over the string that is being filtered: the post-processing
+// filter never produces more characters than it has read, so the write
+// position never passes the read position.
+class InPlaceSink : public OutputSink
 {
-  auto parent_path = filepath.parent_path();
+public:
+  std::string& buffer;
+  size_t size = 0;
 
-  if (!std::filesystem::exists(parent_path))
+public:
+  explicit InPlaceSink(std::string& str)
+    : buffer(str)
   {
-    bool success = std::filesystem::create_directories(parent_path);
 
-    if (!success)
-      throw IOException{ parent_path.string(), "could not create directory" };
   }
+
+  using OutputSink::write;
+
+  void write(const char* data, size_t n) override
+  {
+    std::memmove(&buffer[size], data, n);
+    size += n;
+  }
+};
+
+void LiquidExporter::postProcess(std::string& output)
+{
+  // single pass, equivalent to trim_right() followed by simplify_empty_lines()
+  InPlaceSink sink{ output };
+  PostProcessingFilter filter{ sink };
+  filter.write(output.data(), output.size());
+  filter.finish();
+
+  output.resize(sink.size);
 }
 
-void LiquidExporter::write(const std::string& data, const std::filesystem::path& filepath)
+void LiquidExporter::write(std::string data, const std::filesystem::path& filepath)
 {
   if (data.empty())
     return;
 
-  checkWriteDirectory(filepath);
+  m_output_queue->write(filepath, std::move(data));
+}
+
+std::filesystem::path LiquidExporter::cacheDir() const
+{
+  // kept next to the profile rather than in the published output
+  return std::filesystem::path(folderPath()) / ".dex-cache";
+}
+
+std::string LiquidExporter::templatesSignature(bool content) const
+{
+  // a new version of dex may render the same templates differently
+  std::string data = std::string("dex ") + DEX_VERSION_STR + "\n";
+  data += m_variables_signature;
+
+  auto add_file = [&data, content](const std::filesystem::path& f) {
+    data += f.generic_string() + "\n";
+
+    if (content)
+    {
+      data += file_utils::read_all(f);
+    }
+    else
+    {
+      data += std::to_string(std::filesystem::file_size(f)) + " ";
+      data += std::to_string(std::filesystem::last_write_time(f).time_since_epoch().count()) + "\n";
+    }
+  };
+
+  for (const char* name : { "_layouts", "_includes" })
+  {
+    std::filesystem::path dir = std::filesystem::path(folderPath()) / name;
+
+    if (!std::filesystem::exists(dir))
+      continue;
+
+    std::vector<std::filesystem::path> files;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+      if (entry.is_regular_file())
+        files.push_back(entry.path());
+    }
+
+    std::sort(files.begin(), files.end());
+
+    for (const std::filesystem::path& f : files)
+      add_file(f);
+  }
+
+  std::filesystem::path config_file = std::filesystem::path(folderPath()) / "_config.yml";
+
+  if (std::filesystem::exists(config_file))
+    add_file(config_file);
+
+  return std::to_string(model::hash(data));
+}
+
+std::shared_ptr<Model> LiquidExporter::readCache(CacheSignature& signature) const
+{
+  std::filesystem::path dir = cacheDir();
+  signature.files = templatesSignature(false);
+
+  if (!std::filesystem::exists(dir / "model") || !std::filesystem::exists(dir / "templates"))
+    return nullptr;
+
+  const std::string cached_content = file_utils::read_all(dir / "templates");
+
+  // the templates are only read if their sizes or times changed
+  if (!std::filesystem::exists(dir / "files") || file_utils::read_all(dir / "files") != signature.files)
+  {
+    signature.content = templatesSignature(true);
+
+    if (cached_content != signature.content)
+      return nullptr;
+  }
+  else
+  {
+    signature.content = cached_content;
+  }
+
+  try
+  {
+    return snapshot::load(dir / "model");
+  }
+  catch (const std::exception& ex)
+  {
+    log::warning() << "could not load cached model, all pages will be rendered: " << ex.what();
+    return nullptr;
+  }
+}
+
+void LiquidExporter::writeCache(CacheSignature& signature)
+{
+  std::filesystem::path dir = cacheDir();
+
+  if (signature.content.empty())
+    signature.content = templatesSignature(true);
+
+  try
+  {
+    std::filesystem::create_directories(dir);
+    snapshot::save(*model(), dir / "model");
+    file_utils::write_file(dir / "templates", signature.content);
+    file_utils::write_file(dir / "files", signature.files);
+  }
+  catch (const std::exception& ex)
+  {
+    log::warning() << "could not write model cache: " << ex.what();
+    std::filesystem::remove_all(dir);
+  }
+}
+
+class GroupTableCollector : public DocumentVisitor
+{
+public:
+  std::set<std::string> groups;
+
+protected:
+  void visit(dex::GroupTable& table) override
+  {
+    groups.insert(table.groupname);
+  }
+};
+
+// Decides whether a page must be rendered again given the paths of the
+// objects that changed since the last run.
+// A page depends on its object, the descendants of that object, the
+// related non-members and bases of a class, and the groups displayed
+// in group tables.
+class DirtyPageChecker
+{
+public:
+  const Model& current;
+  std::set<std::string> entities;
+  std::set<std::string> documents;
+  std::set<std::string> groups;
+
+public:
+  DirtyPageChecker(const Model& m, const model::ModelDiff& diff)
+    : current(m)
+  {
+    for (const auto& entry : diff.entities)
+      entities.insert(entry.path);
+
+    for (const auto& entry : diff.documents)
+      documents.insert(entry.path);
+
+    for (const auto& entry : diff.groups)
+      groups.insert(entry.path);
+  }
+
+  bool isDirty(const dex::Entity& e) const
+  {
+    if (subtreeChanged(e))
+      return true;
+
+    if (e.is<dex::Class>())
+    {
+      const auto& cla = static_cast<const dex::Class&>(e);
+
+      for (const BaseClass& b : cla.bases)
+      {
+        if (b.base && entities.count(model::path(*b.base)))
+          return true;
+      }
+
+      auto self = std::static_pointer_cast<dex::Class>(std::const_pointer_cast<dex::Entity>(e.shared_from_this()));
+      std::shared_ptr<RelatedNonMembers::Entry> related = current.program()->related.getRelated(self);
+
+      if (related)
+      {
+        for (const auto& f : related->non_members)
+        {
+          if (entities.count(model::path(*f)))
+            return true;
+        }
+      }
+    }
+
+    GroupTableCollector tables;
+    collectGroupTables(e, tables);
+    return groupsChanged(tables.groups);
+  }
+
+  bool isDirty(const dex::Document& doc) const
+  {
+    if (documents.count(model::path(doc)))
+      return true;
+
+    GroupTableCollector tables;
+    tables.visitDocument(doc);
+    return groupsChanged(tables.groups);
+  }
+
+protected:
+  // whether the entity or one of the entities it contains has changed,
+  // including those that were added or removed
+  bool subtreeChanged(const dex::Entity& e) const
+  {
+    const std::string p = model::path(e);
+
+    if (entities.count(p))
+      return true;
+
+    const std::string prefix = p == "::" ? std::string() : p + "::";
+    auto it = entities.lower_bound(prefix);
+    return it != entities.end() && StdStringCRef(*it).starts_with(prefix);
+  }
+
+  void collectGroupTables(const dex::Entity& e, GroupTableCollector& tables) const
+  {
+    if (e.description)
+      tables.visitDocument(*e.description);
+
+    if (e.is<dex::Namespace>())
+    {
+      for (const auto& child : static_cast<const dex::Namespace&>(e).entities)
+        collectGroupTables(*child, tables);
+    }
+    else if (e.is<dex::Class>())
+    {
+      for (const auto& child : static_cast<const dex::Class&>(e).members)
+        collectGroupTables(*child, tables);
+    }
+  }
+
+  bool groupsChanged(const std::set<std::string>& names) const
+  {
+    for (const std::string& name : names)
+    {
+      if (groups.count(name))
+        return true;
 
-  dex::file_utils::write_file(filepath, data);
+      std::shared_ptr<Group> g = current.groups.get(name);
+
+      if (!g)
+        continue;
+
+      for (const auto& e : g->content.entities)
+      {
+        if (entities.count(model::path(*e)))
+          return true;
+      }
+
+      for (const auto& d : g->content.documents)
+      {
+        if (documents.count(model::path(*d)))
+          return true;
+      }
+    }
+
+    return false;
+  }
+};
+
+static void list_pages(const std::shared_ptr<dex::Entity>& e, std::vector<std::shared_ptr<model::Object>>& pages)
+{
+  pages.push_back(e);
+
+  if (e->is<dex::Namespace>())
+  {
+    for (const auto& child : static_cast<const dex::Namespace&>(*e).entities)
+      list_pages(child, pages);
+  }
+  else if (e->is<dex::Class>())
+  {
+    for (const auto& child : static_cast<const dex::Class&>(*e).members)
+      list_pages(child, pages);
+  }
+}
+
+static std::vector<std::shared_ptr<model::Object>> list_pages(const Model& m)
+{
+  std::vector<std::shared_ptr<model::Object>> pages{ m.documents.begin(), m.documents.end() };
+
+  if (m.program())
+    list_pages(m.program()->globalNamespace(), pages);
+
+  return pages;
+}
+
+void LiquidExporter::selectDirtyPages(const Model& previous)
+{
+  DirtyPageChecker checker{ *model(), model::diff(previous, *model()) };
+
+  m_dirty_pages = std::set<const model::Object*>();
+
+  for (const std::shared_ptr<model::Object>& page : list_pages(*model()))
+  {
+    if (get_url(page).empty())
+      continue;
+
+    bool dirty = page->isDocument() ? checker.isDirty(static_cast<const dex::Document&>(*page))
+                                    : checker.isDirty(static_cast<const dex::Entity&>(*page));
+
+    if (dirty)
+      m_dirty_pages->insert(page.get());
+  }
+
+  // pages whose object no longer exists are removed by the output sync
+
+  log::info() << "rendering " << int(m_dirty_pages->size()) << " page(s) that changed since the last run";
+}
+
+bool LiquidExporter::isDirty(const model::Object& obj) const
+{
+  return !m_dirty_pages.has_value() || m_dirty_pages->count(&obj);
 }
 
 void LiquidExporter::trim_right(std::string& str)
@@ -504,7 +1165,7 @@ void LiquidExporter::trim_right(std::string& str)
 
         while (rr < str.size() && str.at(rr) == ' ') ++rr;
 
-        if (str.at(rr) == '\n') // discard the spaces
+        if (rr < str.size() && str.at(rr) == '\n') // discard the spaces
         {
           r = rr;
         }
@@ -9,12 +9,16 @@
 
 #include "dex/model/model.h"
 
+#include "dex/output/search-index.h"
+
 #include <liquid/renderer.h>
 
 #include <json-toolkit/json.h>
 
 #include <filesystem>
 #include <map>
+#include <optional>
+#include <set>
 #include <variant>
 #include <vector>
 
@@ -24,6 +28,8 @@ namespace dex
 class Model;
 
 class LiquidFilters;
+class OutputQueue;
+class OutputSync;
 class LiquidStringifier;
 
 liquid::Value json_to_liquid(const json::Json& js);
@@ -78,12 +84,23 @@ public:
   void setModel(std::shared_ptr<Model> model);
   std::shared_ptr<Model> model() const;
 
+  LiquidFilters& filters() const;
+
   std::string get_url(const dex::Entity& e) const;
   std::string get_url(const dex::Document& doc) const;
   std::string get_url(const std::shared_ptr<model::Object>& obj) const;
 
 protected:
   friend class LiquidExporterModelVisitor;
+  friend class LiquidPageRenderer;
+
+  struct PageJob
+  {
+    std::shared_ptr<model::Object> object;
+    const char* field;
+    const LiquidLayout* layout;
+    std::string url;
+  };
 
   void dump(const std::shared_ptr<model::Object>& obj, const char* obj_field_name, const LiquidLayout& layout);
 
@@ -91,6 +108,11 @@ protected:
   void dump(dex::Namespace& ns);
   void dump(dex::Document& doc);
 
+  void renderPages();
+  void index(const dex::Entity& e);
+  void index(const dex::Document& doc);
+  void writeSearchIndex();
+
 protected:
   std::string stringify(const liquid::Value& val) override;
   liquid::Value applyFilter(const std::string& name, const liquid::Value& object, const std::vector<liquid::Value>& args) override;
@@ -100,15 +122,32 @@ protected:
   void listLayouts();
   LiquidLayout parseLayout(const std::filesystem::path& fileinfo, const std::string& name, std::string default_out);
   void listIncludes();
+  void loadIncludes(const std::string& source);
 
   void renderDirectory(const std::filesystem::path& path);
   void renderFile(const std::filesystem::path& filepath);
   bool isSpecialFile(const std::filesystem::path& fileinfo) const;
   void selectStringifier(const std::string& filesuffix);
-  void setupContext(liquid::Map& context);
+  void setupBaseContext();
+  liquid::Map pageContext(std::map<std::string, liquid::Value> variables) const;
   void postProcess(std::string& output);
-  void checkWriteDirectory(const std::filesystem::path& filepath);
-  void write(const std::string& data, const std::filesystem::path& filepath);
+  void write(std::string data, const std::filesystem::path& filepath);
+
+  // signature of the templates and configuration the cached model was
+  // rendered with; 'files' only uses the sizes and times of the files and
+  // is checked first, 'content' is computed when needed
+  struct CacheSignature
+  {
+    std::string files;
+    std::string content;
+  };
+
+  std::filesystem::path cacheDir() const;
+  std::string templatesSignature(bool content) const;
+  std::shared_ptr<Model> readCache(CacheSignature& signature) const;
+  void writeCache(CacheSignature& signature);
+  void selectDirtyPages(const Model& previous);
+  bool isDirty(const model::Object& obj) const;
 
 private:
   std::string m_folder_path;
@@ -117,9 +156,17 @@ private:
   std::shared_ptr<Model> m_model;
   Layouts m_layouts;
   liquid::Map m_user_variables;
+  liquid::Map m_base_context;
+  std::string m_variables_signature;
+  std::optional<std::set<const model::Object*>> m_dirty_pages; // all pages are rendered if not set
+  std::vector<PageJob> m_pages;
+  std::map<std::string, std::filesystem::path> m_include_files; // includes are loaded on first use
   std::map<std::string, std::shared_ptr<LiquidStringifier>> m_stringifiers;
   std::shared_ptr<LiquidStringifier> m_stringifier;
   std::unique_ptr<LiquidFilters> m_filters;
+  OutputSync* m_sync = nullptr; // only set during render()
+  OutputQueue* m_output_queue = nullptr; // idem
+  std::unique_ptr<SearchIndex::Builder> m_search_index; // filled while the pages are listed
 };
 
 } // namespace dex
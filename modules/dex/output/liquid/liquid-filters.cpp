@@ -7,11 +7,14 @@
 #include "dex/output/liquid/liquid-exporter.h"
 #include "dex/output/liquid/liquid-wrapper.h"
 
+#include "dex/common/string-pool.h"
 #include "dex/common/string-utils.h"
 
 #include <liquid/filters.h>
 
 #include <algorithm>
+#include <map>
+#include <optional>
 
 namespace dex
 {
@@ -26,63 +29,102 @@ static liquid::Array array_arg(const liquid::Value& object)
     throw std::runtime_error{ "Object is not an array" };
 }
 
-LiquidFilters::LiquidFilters(LiquidExporter& exp)
-  : renderer(exp)
-{
-
-}
-
-LiquidFilters::~LiquidFilters()
+// Returns the model field backing an entity property when that field is
+// an interned string, so that it can be compared by address.
+static const InternedString* interned_field(const liquid::Value& obj, const std::string& field)
 {
-
+  std::shared_ptr<dex::Entity> e = liquid_cast<dex::Entity>(obj);
+
+  if (e == nullptr)
+    return nullptr;
+
+  if (field == "name")
+    return &e->name;
+  else if (field == "return_type" && e->is<dex::Function>())
+    return &static_cast<const dex::Function&>(*e).return_type.type;
+  else if (field == "ptype" && e->is<dex::FunctionParameter>())
+    return &static_cast<const dex::FunctionParameter&>(*e).type;
+  else if (field == "vartype" && e->is<dex::Variable>())
+    return &static_cast<const dex::Variable&>(*e).type();
+  else if (field == "typedef" && e->is<dex::Typedef>())
+    return &static_cast<const dex::Typedef&>(*e).type;
+
+  return nullptr;
 }
 
-liquid::Value LiquidFilters::apply(const std::string& name, const liquid::Value& object, const std::vector<liquid::Value>& args) const
+LiquidFilters::LiquidFilters(LiquidExporter& exp)
+  : renderer(exp)
 {
-  if (name == "filter_by_type")
-  {
+  add("filter_by_type", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return filter_by_type(array_arg(object), args.front().as<std::string>());
-  }
-  else if (name == "filter_by_accessibility")
-  {
+  });
+
+  add("filter_by_accessibility", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return filter_by_accessibility(array_arg(object), args.front().as<std::string>());
-  }
-  else if (name == "filter_by_field")
-  {
+  });
+
+  add("filter_by_field", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return filter_by_field(array_arg(object), args.front().as<std::string>(), args.back().as<std::string>());
-  }
-  else if (name == "funsig")
-  {
+  });
+
+  add("funsig", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
     return funsig(object.toMap());
-  }
-  else if (name == "related_non_members")
-  {
+  });
+
+  add("related_non_members", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
     return related_non_members(object.toMap());
-  }
-  else if (name == "group_get_entities")
-  {
+  });
+
+  add("group_get_entities", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
     return group_get_entities(object.toMap());
-  }
-  else if (name == "group_get_manuals")
-  {
+  });
+
+  add("group_get_manuals", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
     return group_get_manuals(object.toMap());
-  }
-  else if (name == "get_url")
-  {
+  });
+
+  add("get_groups", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
+    return get_groups(object);
+  });
+
+  add("get_url", [this](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
     return get_url(object);
-  }
-  else if (name == "has_any_documented_param")
-  {
+  });
+
+  add("has_any_documented_param", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return has_any_documented_param(object, args);
-  }
-  else if (name == "param_brief_or_name")
-  {
+  });
+
+  add("param_brief_or_name", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return param_brief_or_name(object, args);
-  }
-  else if (name == "markdown_escape")
-  {
+  });
+
+  add("markdown_escape", [](const liquid::Value& object, const std::vector<liquid::Value>& args) -> liquid::Value {
     return markdown_escape(object, args);
-  }
+  });
+}
+
+LiquidFilters::~LiquidFilters()
+{
+
+}
+
+void LiquidFilters::add(const std::string& name, Filter filter)
+{
+  m_filters[name] = std::move(filter);
+}
+
+bool LiquidFilters::has(const std::string& name) const
+{
+  return m_filters.find(name) != m_filters.end();
+}
+
+liquid::Value LiquidFilters::apply(const std::string& name, const liquid::Value& object, const std::vector<liquid::Value>& args) const
+{
+  auto it = m_filters.find(name);
+
+  if (it != m_filters.end())
+    return it->second(object, args);
 
   return liquid::BuiltinFilters::apply(name, object, args);
 }
@@ -91,9 +133,21 @@ liquid::Array LiquidFilters::filter_by_field(const liquid::Array& list, const st
 {
   liquid::Array result;
 
+  // if the value was never interned, no interned field can be equal to it
+  const std::string* interned_value = StringPool::global().find(value);
+
   for (size_t i(0); i < list.length(); ++i)
   {
     liquid::Value obj = list.at(i);
+
+    if (const InternedString* str = interned_field(obj, field))
+    {
+      if (&str->str() == interned_value)
+        result.push(obj);
+
+      continue;
+    }
+
     liquid::Value prop = obj.property(field);
 
     if (prop.is<std::string>() && prop.as<std::string>() == value)
@@ -103,15 +157,72 @@ liquid::Array LiquidFilters::filter_by_field(const liquid::Array& list, const st
   return result;
 }
 
+// returns the class or namespace whose 'members' or 'entities' property
+// is the list, if any; the wrapper memoizes these properties while a page
+// is rendered so the list is recognized by identity, not element by element
+static std::shared_ptr<dex::Entity> list_scope(const liquid::Array& list)
+{
+  if (list.length() == 0 || !LiquidValueCache::current())
+    return nullptr;
+
+  std::shared_ptr<dex::Entity> first = liquid_cast<dex::Entity>(list.at(0));
+  std::shared_ptr<dex::Entity> scope = first ? first->parent() : nullptr;
+
+  if (!scope || !(scope->is<dex::Class>() || scope->is<dex::Namespace>()))
+    return nullptr;
+
+  liquid::Value members = to_liquid(scope).property(scope->is<dex::Class>() ? "members" : "entities");
+
+  return members.impl() == list.impl() ? scope : nullptr;
+}
+
+// members of a class or namespace are also available in buckets
+// by kind and accessibility (e.g. 'class.public_functions')
+static std::optional<liquid::Array> member_bucket(const liquid::Array& list, const std::string& bucket)
+{
+  std::shared_ptr<dex::Entity> scope = list_scope(list);
+
+  if (!scope)
+    return std::nullopt;
+
+  liquid::Value result = to_liquid(scope).property(bucket);
+
+  if (!result.isArray())
+    return std::nullopt;
+
+  return result.toArray();
+}
+
 liquid::Array LiquidFilters::filter_by_type(const liquid::Array& list, const std::string& type)
 {
   static const std::string field = "type";
+
+  static const std::map<std::string, std::string> buckets = {
+    { "namespace", "namespaces" }, { "class", "classes" }, { "enum", "enums" }, 
+    { "function", "functions" }, { "variable", "variables" }, { "typedef", "typedefs" },
+  };
+
+  auto it = buckets.find(type);
+
+  if (it != buckets.end())
+  {
+    if (std::optional<liquid::Array> bucket = member_bucket(list, it->second))
+      return *bucket;
+  }
+
   return filter_by_field(list, field, type);
 }
 
 liquid::Array LiquidFilters::filter_by_accessibility(const liquid::Array& list, const std::string& as)
 {
   static const std::string field = "accessibility";
+
+  if (as == "public" || as == "protected" || as == "private")
+  {
+    if (std::optional<liquid::Array> bucket = member_bucket(list, as + "_members"))
+      return *bucket;
+  }
+
   return filter_by_field(list, field, as);
 }
 
@@ -183,6 +294,16 @@ liquid::Array LiquidFilters::group_get_manuals(const liquid::Map& liqgroup) cons
   return result;
 }
 
+liquid::Array LiquidFilters::get_groups(const liquid::Value& object) const
+{
+  std::shared_ptr<model::Object> obj = from_liquid(object);
+
+  if (obj == nullptr)
+    return {};
+
+  return to_liquid(renderer.model()->groups.groupsOf(*obj)).toArray();
+}
+
 liquid::Value LiquidFilters::get_url(const liquid::Value& object) const
 {
   return renderer.get_url(from_liquid(object));
@@ -203,7 +324,7 @@ liquid::Value LiquidFilters::has_any_documented_param(const liquid::Value& objec
 
 std::string LiquidFilters::param_brief_or_name(const FunctionParameter& fp)
 {
-  return fp.brief.value_or(fp.name);
+  return fp.brief.value_or(fp.name.str());
 }
 
 liquid::Value LiquidFilters::param_brief_or_name(const liquid::Value& object, const std::vector<liquid::Value>& /* args */)
@@ -9,6 +9,9 @@
 
 #include <liquid/value.h>
 
+#include <functional>
+#include <unordered_map>
+
 namespace dex
 {
 
@@ -30,6 +33,13 @@ public:
   explicit LiquidFilters(LiquidExporter& exp);
   ~LiquidFilters();
 
+  typedef std::function<liquid::Value(const liquid::Value&, const std::vector<liquid::Value>&)> Filter;
+
+  // filters must be added before rendering starts;
+  // a filter replaces any filter with the same name, including builtin ones
+  void add(const std::string& name, Filter filter);
+  bool has(const std::string& name) const;
+
   liquid::Value apply(const std::string& name, const liquid::Value& object, const std::vector<liquid::Value>& args) const;
 
 protected:
@@ -40,6 +50,7 @@ protected:
   liquid::Array related_non_members(const liquid::Map& liqclass) const;
   liquid::Array group_get_entities(const liquid::Map& liqgroup) const;
   liquid::Array group_get_manuals(const liquid::Map& liqgroup) const;
+  liquid::Array get_groups(const liquid::Value& object) const;
   liquid::Value get_url(const liquid::Value& object) const;
   static bool has_any_documented_param(const Function& fun);
   static liquid::Value has_any_documented_param(const liquid::Value& object, const std::vector<liquid::Value>& args);
@@ -47,6 +58,9 @@ protected:
   static liquid::Value param_brief_or_name(const liquid::Value& object, const std::vector<liquid::Value>& args);
   static std::string markdown_escape(const std::string& text);
   static liquid::Value markdown_escape(const liquid::Value& object, const std::vector<liquid::Value>& args);
+
+private:
+  std::unordered_map<std::string, Filter> m_filters;
 };
 
 } // namespace dex
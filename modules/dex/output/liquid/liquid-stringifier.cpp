@@ -5,6 +5,7 @@
 #include "dex/output/liquid/liquid-stringifier.h"
 
 #include "dex/output/liquid/liquid-exporter.h"
+#include "dex/output/output-sink.h"
 
 #include "dex/model/code-block.h"
 #include "dex/model/display-math.h"
@@ -33,79 +34,79 @@ std::string LiquidStringifier::stringify(const liquid::Value& val) const
 {
   if (!val.isMap() && !val.isArray())
     return liquid::Renderer::defaultStringify(val);
+
+  std::string result;
+  StringSink sink{ result };
+  write(val, sink);
+  return result;
+}
+
+void LiquidStringifier::write(const liquid::Value& val, OutputSink& out) const
+{
+  if (!val.isMap() && !val.isArray())
+    return out.write(liquid::Renderer::defaultStringify(val));
   else if (val.isArray())
-    return stringify_array(val.toArray());
+    return write_array(val.toArray(), out);
 
   auto dom_node = liquid_cast<dex::DocumentNode>(val);
 
   if (dom_node)
-    return stringify_domnode(*dom_node);
+    return write_domnode(*dom_node, out);
 
   assert(("Not implemented", false));
-  return {};
 }
 
-std::string LiquidStringifier::stringify_domnode(const dex::DocumentNode& node) const
+void LiquidStringifier::write_domnode(const dex::DocumentNode& node, OutputSink& out) const
 {
   if (node.is<dex::Paragraph>())
-    return stringify_paragraph(static_cast<const dex::Paragraph&>(node));
+    out << stringify_paragraph(static_cast<const dex::Paragraph&>(node));
   else if (node.is<dex::List>())
-    return stringify_list(static_cast<const dex::List&>(node));
+    write_list(static_cast<const dex::List&>(node), out);
   else if (node.is<dex::ListItem>())
-    return stringify_listitem(static_cast<const dex::ListItem&>(node));
+    write_listitem(static_cast<const dex::ListItem&>(node), out);
   else if (node.is<dex::Image>())
-    return stringify_image(static_cast<const dex::Image&>(node));
+    out << stringify_image(static_cast<const dex::Image&>(node));
   else if (node.is<dex::BeginSince>())
-    return stringify_beginsince(static_cast<const dex::BeginSince&>(node));
+    out << stringify_beginsince(static_cast<const dex::BeginSince&>(node));
   else if (node.is<dex::EndSince>())
-    return stringify_endsince(static_cast<const dex::EndSince&>(node));
+    out << stringify_endsince(static_cast<const dex::EndSince&>(node));
   else if (node.is<dex::Sectioning>())
-    return stringify_section(static_cast<const dex::Sectioning&>(node));
+    write_section(static_cast<const dex::Sectioning&>(node), out);
   else if (node.is<dex::DisplayMath>())
-    return stringify_math(static_cast<const dex::DisplayMath&>(node));
+    out << stringify_math(static_cast<const dex::DisplayMath&>(node));
   else if (node.is<dex::GroupTable>())
-    return stringify_grouptable(static_cast<const dex::GroupTable&>(node));
+    out << stringify_grouptable(static_cast<const dex::GroupTable&>(node));
   else if (node.is<dex::CodeBlock>())
-    return stringify_codeblock(static_cast<const dex::CodeBlock&>(node));  
+    out << stringify_codeblock(static_cast<const dex::CodeBlock&>(node));
   else if (node.is<dex::TableOfContents>())
-    return stringify_tableofcontents(static_cast<const dex::TableOfContents&>(node));
+    out << stringify_tableofcontents(static_cast<const dex::TableOfContents&>(node));
   else if (node.is<dex::Index>())
-    return stringify_index(static_cast<const dex::Index&>(node));
+    out << stringify_index(static_cast<const dex::Index&>(node));
   else if (node.is<dex::FrontMatter>())
-    return stringify_frontmatter(static_cast<const dex::FrontMatter&>(node));
+    out << stringify_frontmatter(static_cast<const dex::FrontMatter&>(node));
   else if (node.is<dex::MainMatter>())
-    return stringify_mainmatter(static_cast<const dex::MainMatter&>(node));
+    out << stringify_mainmatter(static_cast<const dex::MainMatter&>(node));
   else if (node.is<dex::BackMatter>())
-    return stringify_backmatter(static_cast<const dex::BackMatter&>(node));
-
-  assert(("dom element not implemented", false));
-  return {};
+    out << stringify_backmatter(static_cast<const dex::BackMatter&>(node));
+  else
+    assert(("dom element not implemented", false));
 }
 
-std::string LiquidStringifier::stringify_domcontent(const dex::DomNodeList& content) const
+void LiquidStringifier::write_domcontent(const dex::DomNodeList& content, OutputSink& out) const
 {
-  std::string result;
-
   for (const auto& node : content)
   {
-    result += stringify_domnode(*node);
+    write_domnode(*node, out);
   }
-
-  return result;
 }
 
-std::string LiquidStringifier::stringify_array(const liquid::Array& list) const
+void LiquidStringifier::write_array(const liquid::Array& list, OutputSink& out) const
 {
-  std::string result;
-
   for (size_t i(0); i < list.length(); ++i)
   {
-    liquid::Value val = list.at(i);
-    result += stringify(val);
-    result += "\n\n";
+    write(list.at(i), out);
+    out << "\n\n";
   }
-
-  return result;
 }
 
 } // namespace dex
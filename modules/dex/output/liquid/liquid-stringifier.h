@@ -33,6 +33,7 @@ class Sectioning;
 class TableOfContents;
 
 class LiquidExporter;
+class OutputSink;
 
 class DEX_OUTPUT_API LiquidStringifier
 {
@@ -46,14 +47,19 @@ public:
   virtual void selected();
 
   std::string stringify(const liquid::Value& val) const;
+  void write(const liquid::Value& val, OutputSink& out) const;
 
 protected:
-  virtual std::string stringify_domnode(const dex::DocumentNode& node) const;
-  virtual std::string stringify_domcontent(const dex::DomNodeList& content) const;
+  // nodes that may contain other nodes are written to the sink,
+  // leaf nodes are converted to strings
+  virtual void write_domnode(const dex::DocumentNode& node, OutputSink& out) const;
+  virtual void write_domcontent(const dex::DomNodeList& content, OutputSink& out) const;
+
+  virtual void write_array(const liquid::Array& list, OutputSink& out) const;
+  virtual void write_list(const dex::List& list, OutputSink& out) const = 0;
+  virtual void write_listitem(const dex::ListItem& li, OutputSink& out) const = 0;
+  virtual void write_section(const dex::Sectioning& sec, OutputSink& out) const = 0;
 
-  virtual std::string stringify_array(const liquid::Array& list) const;
-  virtual std::string stringify_list(const dex::List& list) const = 0;
-  virtual std::string stringify_listitem(const dex::ListItem& li) const = 0;
   virtual std::string stringify_paragraph(const dex::Paragraph& par) const = 0;
   virtual std::string stringify_beginsince(const dex::BeginSince& bsince) const = 0;
   virtual std::string stringify_endsince(const dex::EndSince& esince) const = 0;
@@ -65,7 +71,6 @@ protected:
   virtual std::string stringify_frontmatter(const dex::FrontMatter& fm) const = 0;
   virtual std::string stringify_mainmatter(const dex::MainMatter& mm) const = 0;
   virtual std::string stringify_backmatter(const dex::BackMatter& bm) const = 0;
-  virtual std::string stringify_section(const dex::Sectioning& sec) const = 0;
   virtual std::string stringify_tableofcontents(const dex::TableOfContents& toc) const = 0;
   virtual std::string stringify_index(const dex::Index& idx) const = 0;
 };
@@ -9,6 +9,9 @@
 #include "dex/model/paragraph-annotations.h"
 #include "dex/model/since.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace dex
 {
 
@@ -23,221 +26,346 @@ liquid::Value to_liquid(const std::optional<T>& val)
   return val.has_value() ? to_liquid(val.value()) : liquid::Value();
 }
 
-class LiquidPropertyVisitorEntity : public ProgramVisitor
+// Entities of a given kind in breadth-first order, classes, enums and
+// functions are only found in namespaces and classes.
+static liquid::Value entities_of_kind(const Program& prog, model::Kind kind)
 {
-public:
-  const std::string& propertyName;
-  liquid::Value result;
+  liquid::Array r;
+  std::vector<const Entity*> scopes;
+
+  if (prog.globalNamespace())
+    scopes.push_back(prog.globalNamespace().get());
 
-public:
-  LiquidPropertyVisitorEntity(const std::string& pname)
-    : propertyName(pname)
+  for (size_t i(0); i < scopes.size(); ++i)
   {
+    const std::vector<std::shared_ptr<Entity>>& children = scopes.at(i)->is<Class>() ?
+      static_cast<const Class*>(scopes.at(i))->members : static_cast<const Namespace*>(scopes.at(i))->entities;
 
-  }
+    for (const auto& e : children)
+    {
+      if (e->kind() == kind)
+        r.push(to_liquid(e));
 
-  void setval(liquid::Value val)
-  {
-    result = val;
+      if (e->is<Class>() || e->is<Namespace>())
+        scopes.push_back(e.get());
+    }
   }
 
-  void visit(dex::Entity& e) override
-  {
-    if (propertyName == "name")
-      return setval(e.name);
-    else if (propertyName == "parent")
-      return setval(to_liquid(e.parent()));
-    else if (propertyName == "type")
-      return setval(e.className());
-    else if (propertyName == "accessibility")
-      return setval(to_string(e.getAccessSpecifier()));
-    else if (propertyName == "brief")
-      return setval(to_liquid(e.brief));
-    else if (propertyName == "since")
-      return setval(to_liquid(e.since));
-    else if (propertyName == "description")
-      return setval(e.description ? to_liquid(e.description->nodes) : liquid::Value());
-    else
-      return dispatch(e);
-  }
+  return r;
+}
 
-  void visit(dex::Namespace& ns) override
-  {
-    if (propertyName == "entities")
-      return setval(to_liquid(ns.entities));
-  }
+// Liquid properties of the model objects, indexed by object kind.
+// Each property is a direct call to an accessor function.
+// The per-class arrays are compile-time constants; they are merged into
+// one hash table per kind the first time a property is looked up.
 
-  void visit(dex::Class& cla) override
-  {
-    if (propertyName == "members")
-      return setval(to_liquid(cla.members));
-  }
+using LiquidPropertyAccessor = liquid::Value(*)(model::Object&);
 
-  void visit(dex::Enum& en) override
-  {
-    if (propertyName == "values")
-      return setval(to_liquid(en.values));
-  }
+struct LiquidProperty
+{
+  const char* name;
+  LiquidPropertyAccessor get;
+  bool memoized = false; // collections are converted once per render, see LiquidValueCache
+};
 
-  void visit(dex::EnumValue& ev) override
-  {
-    if (propertyName == "value")
-      return setval(ev.value());
-  }
+template<typename T>
+static T& self(model::Object& obj)
+{
+  return static_cast<T&>(obj);
+}
 
-  void visit(dex::Function& f) override
-  {
-    if (propertyName == "return_type")
-      return setval(f.return_type.type);
-    else if (propertyName == "returns")
-      return setval(to_liquid(f.return_type.brief));
-    else if (propertyName == "specifiers")
-      return setval(f.specifiersList());
-    else if (propertyName == "parameters")
-      return setval(to_liquid(f.parameters));
-  }
+static constexpr LiquidProperty entity_properties[] = {
+  { "name", [](model::Object& o) -> liquid::Value { return self<Entity>(o).name.str(); } },
+  { "parent", [](model::Object& o) -> liquid::Value { return to_liquid(self<Entity>(o).parent()); } },
+  { "type", [](model::Object& o) -> liquid::Value { return self<Entity>(o).className(); } },
+  { "accessibility", [](model::Object& o) -> liquid::Value { return to_string(self<Entity>(o).getAccessSpecifier()); } },
+  { "brief", [](model::Object& o) -> liquid::Value { return to_liquid(self<Entity>(o).brief); } },
+  { "since", [](model::Object& o) -> liquid::Value { return to_liquid(self<Entity>(o).since); } },
+  { "description", [](model::Object& o) -> liquid::Value {
+      const auto& e = self<Entity>(o);
+      return e.description ? to_liquid(e.description->nodes) : liquid::Value();
+    }, true
+  },
+};
 
-  void visit(dex::FunctionParameter& fp) override
-  {
-    if (propertyName == "ptype")
-      return setval(fp.type);
-  }
+static constexpr LiquidProperty namespace_properties[] = {
+  { "entities", [](model::Object& o) -> liquid::Value { return to_liquid(self<Namespace>(o).entities); }, true },
+};
 
-  void visit(dex::Variable& v) override
-  {
-    if (propertyName == "vartype")
-      return setval(v.type());
-  }
+static constexpr LiquidProperty class_properties[] = {
+  { "members", [](model::Object& o) -> liquid::Value { return to_liquid(self<Class>(o).members); }, true },
+};
 
-  void visit(dex::Typedef& t) override
-  {
-    if (propertyName == "typedef")
-      return setval(t.type);
-  }
+static constexpr LiquidProperty enum_properties[] = {
+  { "values", [](model::Object& o) -> liquid::Value { return to_liquid(self<Enum>(o).values); }, true },
+};
 
-  void visit(dex::Macro& m) override
-  {
-    if (propertyName == "parameters")
-      return setval(to_liquid(m.parameters));
-  }
+static constexpr LiquidProperty enumvalue_properties[] = {
+  { "value", [](model::Object& o) -> liquid::Value { return self<EnumValue>(o).value(); } },
 };
 
-class LiquidPropertyVisitorDom : public DocumentVisitor
-{
-public:
-  const std::string& propertyName;
-  liquid::Value result;
+static constexpr LiquidProperty function_properties[] = {
+  { "return_type", [](model::Object& o) -> liquid::Value { return self<Function>(o).return_type.type.str(); } },
+  { "returns", [](model::Object& o) -> liquid::Value { return to_liquid(self<Function>(o).return_type.brief); } },
+  { "specifiers", [](model::Object& o) -> liquid::Value { return self<Function>(o).specifiersList(); } },
+  { "parameters", [](model::Object& o) -> liquid::Value { return to_liquid(self<Function>(o).parameters); }, true },
+};
 
-public:
-  LiquidPropertyVisitorDom(const std::string& pname)
-    : propertyName(pname)
-  {
+static constexpr LiquidProperty functionparameter_properties[] = {
+  { "ptype", [](model::Object& o) -> liquid::Value { return self<FunctionParameter>(o).type.str(); } },
+};
 
-  }
+static constexpr LiquidProperty variable_properties[] = {
+  { "vartype", [](model::Object& o) -> liquid::Value { return self<Variable>(o).type().str(); } },
+};
 
-  void setval(liquid::Value val)
-  {
-    result = val;
-  }
+static constexpr LiquidProperty typedef_properties[] = {
+  { "typedef", [](model::Object& o) -> liquid::Value { return self<Typedef>(o).type.str(); } },
+};
 
-  void visitNode(dex::DocumentNode& n) override
-  {
-    if (propertyName == "parent")
-      return setval(to_liquid(n.weak_parent.lock()));
-    else
-      return dispatch(n);
-  }
+static constexpr LiquidProperty macro_properties[] = {
+  { "parameters", [](model::Object& o) -> liquid::Value { return to_liquid(self<Macro>(o).parameters); }, true },
+};
 
-  void visit(dex::Image& img) override
-  {
-    if (propertyName == "width")
-      return setval(img.width);
-    else if (propertyName == "height")
-      return setval(img.height);
-    else if (propertyName == "src")
-      return setval(img.src);
-  }
+static constexpr LiquidProperty domnode_properties[] = {
+  { "parent", [](model::Object& o) -> liquid::Value { return to_liquid(self<DocumentNode>(o).weak_parent.lock()); } },
+};
 
-  void visit(dex::List& l) override
-  {
+static constexpr LiquidProperty image_properties[] = {
+  { "width", [](model::Object& o) -> liquid::Value { return self<Image>(o).width; } },
+  { "height", [](model::Object& o) -> liquid::Value { return self<Image>(o).height; } },
+  { "src", [](model::Object& o) -> liquid::Value { return self<Image>(o).src; } },
+};
 
-  }
+static constexpr LiquidProperty paragraph_properties[] = {
+  { "text", [](model::Object& o) -> liquid::Value { return self<Paragraph>(o).text(); } },
+  { "metadata", [](model::Object& o) -> liquid::Value { return to_liquid(self<Paragraph>(o).metadata()); }, true },
+};
 
-  void visit(dex::ListItem& li) override
-  {
+static constexpr LiquidProperty beginsince_properties[] = {
+  { "version", [](model::Object& o) -> liquid::Value { return self<BeginSince>(o).version; } },
+};
 
-  }
+static constexpr LiquidProperty endsince_properties[] = {
+  { "version", [](model::Object& o) -> liquid::Value { return self<EndSince>(o).beginsince.lock()->version; } },
+};
 
-  void visit(dex::Paragraph& par) override
-  {
-    if (propertyName == "text")
-      return setval(par.text());
-    else if (propertyName == "metadata")
-      return setval(to_liquid(par.metadata()));
-  }
+static constexpr LiquidProperty displaymath_properties[] = {
+  { "source", [](model::Object& o) -> liquid::Value { return self<DisplayMath>(o).source; } },
+};
 
-  void visit(dex::BeginSince& bsince) override
-  {
-    if (propertyName == "version")
-      return setval(bsince.version);
-  }
+static constexpr LiquidProperty codeblock_properties[] = {
+  { "lang", [](model::Object& o) -> liquid::Value { return self<CodeBlock>(o).lang; } },
+  { "code", [](model::Object& o) -> liquid::Value { return self<CodeBlock>(o).code; } },
+};
+
+static constexpr LiquidProperty document_properties[] = {
+  { "doctype", [](model::Object& o) -> liquid::Value { return self<Document>(o).doctype; } },
+  { "type", [](model::Object& o) -> liquid::Value { return self<Document>(o).className(); } },
+  { "title", [](model::Object& o) -> liquid::Value { return self<Document>(o).title; } },
+  { "content", [](model::Object& o) -> liquid::Value { return to_liquid(self<Document>(o).nodes); }, true },
+};
+
+static constexpr LiquidProperty program_properties[] = {
+  { "global_namespace", [](model::Object& o) -> liquid::Value { return to_liquid(self<Program>(o).global_namespace); } },
+  { "macros", [](model::Object& o) -> liquid::Value { return to_liquid(self<Program>(o).macros); }, true },
+  { "classes", [](model::Object& o) -> liquid::Value { return entities_of_kind(self<Program>(o), model::Kind::Class); }, true },
+  { "enums", [](model::Object& o) -> liquid::Value { return entities_of_kind(self<Program>(o), model::Kind::Enum); }, true },
+  { "functions", [](model::Object& o) -> liquid::Value { return entities_of_kind(self<Program>(o), model::Kind::Function); }, true },
+};
+
+static constexpr LiquidProperty group_properties[] = {
+  { "name", [](model::Object& o) -> liquid::Value { return self<Group>(o).name; } },
+  { "entities", [](model::Object& o) -> liquid::Value { return to_liquid(self<Group>(o).content.entities); }, true },
+  { "documents", [](model::Object& o) -> liquid::Value { return to_liquid(self<Group>(o).content.documents); }, true },
+};
+
+// Members of a class or namespace of a given kind and accessibility,
+// 'any' matching all kinds or all accessibilities.
 
-  void visit(dex::EndSince& esince) override
+constexpr int any = -1;
+
+static const std::vector<std::shared_ptr<Entity>>& scope_members(model::Object& o)
+{
+  return o.is<Class>() ? self<Class>(o).members : self<Namespace>(o).entities;
+}
+
+template<int K, int A>
+static liquid::Value member_bucket(model::Object& o)
+{
+  liquid::Array result;
+
+  for (const auto& e : scope_members(o))
   {
-    if (propertyName == "version")
-      return setval(esince.beginsince.lock()->version);
+    if ((K == any || e->kind() == static_cast<model::Kind>(K)) && (A == any || e->getAccessSpecifier() == static_cast<AccessSpecifier>(A)))
+      result.push(to_liquid(e));
   }
 
-  void visit(dex::DisplayMath& math) override
+  return result;
+}
+
+static constexpr LiquidProperty namespace_bucket_properties[] = {
+  { "namespaces", &member_bucket<static_cast<int>(model::Kind::Namespace), any>, true },
+  { "classes", &member_bucket<static_cast<int>(model::Kind::Class), any>, true },
+  { "enums", &member_bucket<static_cast<int>(model::Kind::Enum), any>, true },
+  { "functions", &member_bucket<static_cast<int>(model::Kind::Function), any>, true },
+  { "variables", &member_bucket<static_cast<int>(model::Kind::Variable), any>, true },
+  { "typedefs", &member_bucket<static_cast<int>(model::Kind::Typedef), any>, true },
+};
+
+static constexpr LiquidProperty class_bucket_properties[] = {
+  { "classes", &member_bucket<static_cast<int>(model::Kind::Class), any>, true },
+  { "enums", &member_bucket<static_cast<int>(model::Kind::Enum), any>, true },
+  { "functions", &member_bucket<static_cast<int>(model::Kind::Function), any>, true },
+  { "variables", &member_bucket<static_cast<int>(model::Kind::Variable), any>, true },
+  { "typedefs", &member_bucket<static_cast<int>(model::Kind::Typedef), any>, true },
+  { "public_members", &member_bucket<any, static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "protected_members", &member_bucket<any, static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "private_members", &member_bucket<any, static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+  { "public_classes", &member_bucket<static_cast<int>(model::Kind::Class), static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "public_enums", &member_bucket<static_cast<int>(model::Kind::Enum), static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "public_functions", &member_bucket<static_cast<int>(model::Kind::Function), static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "public_variables", &member_bucket<static_cast<int>(model::Kind::Variable), static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "public_typedefs", &member_bucket<static_cast<int>(model::Kind::Typedef), static_cast<int>(AccessSpecifier::PUBLIC)>, true },
+  { "protected_classes", &member_bucket<static_cast<int>(model::Kind::Class), static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "protected_enums", &member_bucket<static_cast<int>(model::Kind::Enum), static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "protected_functions", &member_bucket<static_cast<int>(model::Kind::Function), static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "protected_variables", &member_bucket<static_cast<int>(model::Kind::Variable), static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "protected_typedefs", &member_bucket<static_cast<int>(model::Kind::Typedef), static_cast<int>(AccessSpecifier::PROTECTED)>, true },
+  { "private_classes", &member_bucket<static_cast<int>(model::Kind::Class), static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+  { "private_enums", &member_bucket<static_cast<int>(model::Kind::Enum), static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+  { "private_functions", &member_bucket<static_cast<int>(model::Kind::Function), static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+  { "private_variables", &member_bucket<static_cast<int>(model::Kind::Variable), static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+  { "private_typedefs", &member_bucket<static_cast<int>(model::Kind::Typedef), static_cast<int>(AccessSpecifier::PRIVATE)>, true },
+};
+
+struct LiquidPropertyTable
+{
+  std::unordered_map<std::string, const LiquidProperty*> accessors;
+  std::set<std::string> names;
+
+  template<size_t N>
+  void add(const LiquidProperty (&properties)[N])
   {
-    if (propertyName == "source")
-      return setval(math.source);
+    for (const LiquidProperty& p : properties)
+    {
+      // the first definition of a property wins
+      if (accessors.emplace(p.name, &p).second)
+        names.insert(p.name);
+    }
   }
+};
 
-  void visit(dex::GroupTable& table) override
-  {
+static std::vector<LiquidPropertyTable> build_property_tables()
+{
+  std::vector<LiquidPropertyTable> tables{ static_cast<size_t>(model::Kind::Macro) + 1 };
 
-  }
+  auto table = [&tables](model::Kind k) -> LiquidPropertyTable& {
+    return tables[static_cast<size_t>(k)];
+  };
 
-  void visit(dex::CodeBlock& codeblock) override
+  for (model::Kind k : { model::Kind::Namespace, model::Kind::Enum, model::Kind::EnumValue, model::Kind::Class, 
+    model::Kind::Function, model::Kind::FunctionParameter, model::Kind::TemplateParameter, model::Kind::Variable,
+    model::Kind::Typedef, model::Kind::Macro })
   {
-    if (propertyName == "lang")
-      return setval(codeblock.lang);
-    else if (propertyName == "code")
-      return setval(codeblock.code);
+    table(k).add(entity_properties);
   }
 
+  table(model::Kind::Namespace).add(namespace_properties);
+  table(model::Kind::Namespace).add(namespace_bucket_properties);
+  table(model::Kind::Class).add(class_properties);
+  table(model::Kind::Class).add(class_bucket_properties);
+  table(model::Kind::Enum).add(enum_properties);
+  table(model::Kind::EnumValue).add(enumvalue_properties);
+  table(model::Kind::Function).add(function_properties);
+  table(model::Kind::FunctionParameter).add(functionparameter_properties);
+  table(model::Kind::Variable).add(variable_properties);
+  table(model::Kind::Typedef).add(typedef_properties);
+  table(model::Kind::Macro).add(macro_properties);
 
-  void visit(dex::FrontMatter& fm) override
+  for (model::Kind k : { model::Kind::Paragraph, model::Kind::Link, model::Kind::TextStyle, model::Kind::Note,
+    model::Kind::List, model::Kind::ListItem, model::Kind::Image, model::Kind::GroupTable, model::Kind::FrontMatter,
+    model::Kind::MainMatter, model::Kind::BackMatter, model::Kind::Sectioning, model::Kind::TableOfContents,
+    model::Kind::Index, model::Kind::DisplayMath, model::Kind::Since, model::Kind::BeginSince, model::Kind::EndSince,
+    model::Kind::CodeBlock, model::Kind::InlineMath, model::Kind::IndexEntry })
   {
-
+    table(k).add(domnode_properties);
   }
 
-  void visit(dex::MainMatter& mm) override
-  {
+  table(model::Kind::Image).add(image_properties);
+  table(model::Kind::Paragraph).add(paragraph_properties);
+  table(model::Kind::BeginSince).add(beginsince_properties);
+  table(model::Kind::EndSince).add(endsince_properties);
+  table(model::Kind::DisplayMath).add(displaymath_properties);
+  table(model::Kind::CodeBlock).add(codeblock_properties);
 
-  }
+  table(model::Kind::Document).add(document_properties);
+  table(model::Kind::Program).add(program_properties);
+  table(model::Kind::Group).add(group_properties);
 
-  void visit(dex::BackMatter& bm) override
-  {
+  return tables;
+}
 
-  }
+static const LiquidPropertyTable& property_table(model::Kind kind)
+{
+  static const std::vector<LiquidPropertyTable> static_tables = build_property_tables();
+  return static_tables.at(static_cast<size_t>(kind));
+}
 
-  void visit(dex::Sectioning& section) override
-  {
+static thread_local LiquidValueCache* g_current_cache = nullptr;
 
-  }
+LiquidValueCache::LiquidValueCache()
+  : m_previous(g_current_cache)
+{
+  g_current_cache = this;
+}
 
-  void visit(dex::TableOfContents& toc) override
-  {
+LiquidValueCache::~LiquidValueCache()
+{
+  g_current_cache = m_previous;
+}
 
-  }
+LiquidValueCache* LiquidValueCache::current()
+{
+  return g_current_cache;
+}
+
+LiquidValueCache::Scope::Scope(LiquidValueCache* cache)
+  : m_previous(g_current_cache)
+{
+  g_current_cache = cache;
+}
+
+LiquidValueCache::Scope::~Scope()
+{
+  g_current_cache = m_previous;
+}
+
+liquid::Value LiquidValueCache::get(model::Object& obj, liquid::Value(*accessor)(model::Object&))
+{
+  const Key key{ &obj, accessor };
 
-  void visit(dex::Index& idx) override
   {
+    std::shared_lock<std::shared_mutex> lock{ m_mutex };
+    auto it = m_values.find(key);
 
+    if (it != m_values.end())
+      return it->second;
   }
-};
+
+  liquid::Value val = accessor(obj);
+
+  // another thread may have converted the same value in the meantime,
+  // the first one is kept
+  std::unique_lock<std::shared_mutex> lock{ m_mutex };
+  return m_values.emplace(key, val).first->second;
+}
+
+size_t LiquidValueCache::size() const
+{
+  std::shared_lock<std::shared_mutex> lock{ m_mutex };
+  return m_values.size();
+}
 
 LiquidModel::LiquidModel(const std::shared_ptr<Model>& m)
   : model(m)
@@ -262,7 +390,7 @@ bool LiquidModel::is_map() const
 
 std::set<std::string> LiquidModel::propertyNames() const
 {
-  return { "program", "documents" };
+  return { "program", "documents", "groups" };
 }
 
 liquid::Value LiquidModel::property(const std::string& name) const
@@ -285,6 +413,43 @@ liquid::Value LiquidModel::property(const std::string& name) const
   }
 }
 
+LiquidContextOverlay::LiquidContextOverlay(liquid::Map b, std::map<std::string, liquid::Value> vars)
+  : base(std::move(b)),
+    variables(std::move(vars))
+{
+
+}
+
+std::type_index LiquidContextOverlay::type_index() const
+{
+  return std::type_index(typeid(LiquidContextOverlay));
+}
+
+void* LiquidContextOverlay::data()
+{
+  return this;
+}
+
+bool LiquidContextOverlay::is_map() const
+{
+  return true;
+}
+
+std::set<std::string> LiquidContextOverlay::propertyNames() const
+{
+  std::set<std::string> result = base.propertyNames();
+
+  for (const auto& entry : variables)
+    result.insert(entry.first);
+
+  return result;
+}
+
+liquid::Value LiquidContextOverlay::property(const std::string& name) const
+{
+  auto it = variables.find(name);
+  return it != variables.end() ? it->second : base.property(name);
+}
 
 LiquidModelObject::LiquidModelObject(std::shared_ptr<model::Object> obj)
   : object(obj)
@@ -309,55 +474,26 @@ bool LiquidModelObject::is_map() const
 
 std::set<std::string> LiquidModelObject::propertyNames() const
 {
-  // @TODO
-  return {};
+  return object ? property_table(object->kind()).names : std::set<std::string>();
 }
 
 liquid::Value LiquidModelObject::property(const std::string& name) const
 {
   if (!object)
-  {
     return {};
-  }
-  else if (object->isProgramEntity())
-  {
-    LiquidPropertyVisitorEntity visitor{ name };
-    visitor.visit(static_cast<dex::Entity&>(*object));
-    return visitor.result;
-  }
-  else if (object->isDocumentNode())
-  {
-    if (object->is<dex::Document>())
-    {
-      dex::Document& doc = static_cast<dex::Document&>(*object);
-
-      if (name == "doctype")
-        return doc.doctype;
-      else if (name == "type")
-        return doc.className();
-      else if (name == "title")
-        return doc.title;
-      else if (name == "content")
-        return to_liquid(doc.nodes);
-    }
-    else
-    {
-      LiquidPropertyVisitorDom visitor{ name };
-      visitor.visitNode(static_cast<dex::DocumentNode&>(*object));
-      return visitor.result;
-    }
-  }
-  else if (object->is<dex::Program>())
-  {
-    auto& prog = static_cast<dex::Program&>(*object);
 
-    if (name == "global_namespace")
-      return to_liquid(prog.global_namespace);
-    else if (name == "macros")
-      return to_liquid(prog.macros);
-  }
+  const LiquidPropertyTable& table = property_table(object->kind());
+  auto it = table.accessors.find(name);
+
+  if (it == table.accessors.end())
+    return {};
+
+  const LiquidProperty& prop = *it->second;
+
+  if (prop.memoized && LiquidValueCache::current())
+    return LiquidValueCache::current()->get(*object, prop.get);
 
-  return {};
+  return prop.get(*object);
 }
 
 } // namespace dex
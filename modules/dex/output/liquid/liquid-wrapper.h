@@ -11,6 +11,9 @@
 
 #include <liquid/value.h>
 
+#include <map>
+#include <shared_mutex>
+
 namespace dex
 {
 
@@ -30,6 +33,78 @@ public:
   liquid::Value property(const std::string& name) const override;
 };
 
+// Liquid values of the collections of the model (members, entities,
+// parameters, descriptions...) converted at most once while the cache
+// exists; the model must not change during that time.
+// The cache is current on the thread that creates it; other threads
+// can share it through a Scope.
+class DEX_OUTPUT_API LiquidValueCache
+{
+public:
+  LiquidValueCache();
+  LiquidValueCache(const LiquidValueCache&) = delete;
+  ~LiquidValueCache();
+
+  static LiquidValueCache* current();
+
+  // makes a cache current on the calling thread
+  class DEX_OUTPUT_API Scope
+  {
+  public:
+    explicit Scope(LiquidValueCache* cache);
+    Scope(const Scope&) = delete;
+    ~Scope();
+
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    LiquidValueCache* m_previous;
+  };
+
+  liquid::Value get(model::Object& obj, liquid::Value(*accessor)(model::Object&));
+
+  size_t size() const;
+
+  LiquidValueCache& operator=(const LiquidValueCache&) = delete;
+
+private:
+  using Accessor = liquid::Value(*)(model::Object&);
+  using Key = std::pair<const model::Object*, Accessor>;
+
+  struct KeyLess
+  {
+    bool operator()(const Key& a, const Key& b) const
+    {
+      if (a.first != b.first)
+        return std::less<const model::Object*>()(a.first, b.first);
+
+      return std::less<Accessor>()(a.second, b.second);
+    }
+  };
+
+  LiquidValueCache* m_previous;
+  mutable std::shared_mutex m_mutex;
+  std::map<Key, liquid::Value, KeyLess> m_values;
+};
+
+// Page-specific variables on top of a context shared by all pages
+class DEX_OUTPUT_API LiquidContextOverlay : public liquid::IValue
+{
+public:
+  liquid::Map base;
+  std::map<std::string, liquid::Value> variables;
+
+public:
+  LiquidContextOverlay(liquid::Map b, std::map<std::string, liquid::Value> vars);
+
+  std::type_index type_index() const override;
+  void* data() override;
+
+  bool is_map() const override;
+  std::set<std::string> propertyNames() const override;
+  liquid::Value property(const std::string& name) const override;
+};
+
 class DEX_OUTPUT_API LiquidModelObject : public liquid::IValue
 {
 public:
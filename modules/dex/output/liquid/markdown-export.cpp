@@ -5,6 +5,7 @@
 #include "dex/output/liquid/markdown-export.h"
 
 #include "dex/output/liquid/liquid-exporter.h"
+#include "dex/output/output-sink.h"
 #include "dex/output/paragraph-converter.h"
 
 #include "dex/model/code-block.h"
@@ -103,34 +104,27 @@ public:
 
 MarkdownStringifier::MarkdownStringifier(LiquidExporter& exp)
   : LiquidStringifier(exp)
-{
-
-}
-
-void MarkdownStringifier::selected()
 {
   liquid::Value val = renderer.variables().property("markdown").property("just_the_docs");
   just_the_docs = (val.is<bool>() && val.as<bool>()) 
     || (val.is<std::string>() && val.as<std::string>() == "true");
 }
 
-std::string MarkdownStringifier::stringify_list(const dex::List& list) const
+void MarkdownStringifier::write_list(const dex::List& list, OutputSink& out) const
 {
   // @TODO: handle nested list
 
-  std::string result;
-
   for (const auto& li : list.items)
   {
-    result += "- " + stringify_listitem(static_cast<dex::ListItem&>(*li)) + "\n";
+    out << "- ";
+    write_listitem(static_cast<dex::ListItem&>(*li), out);
+    out << "\n";
   }
-
-  return result;
 }
 
-std::string MarkdownStringifier::stringify_listitem(const dex::ListItem& li) const
+void MarkdownStringifier::write_listitem(const dex::ListItem& li, OutputSink& out) const
 {
-  return stringify_domcontent(li.content);
+  write_domcontent(li.content, out);
 }
 
 std::string MarkdownStringifier::stringify_paragraph(const dex::Paragraph& par) const
@@ -233,23 +227,18 @@ std::string MarkdownStringifier::stringify_backmatter(const dex::BackMatter& bm)
   return std::string();
 }
 
-std::string MarkdownStringifier::stringify_section(const dex::Sectioning& sec) const
+void MarkdownStringifier::write_section(const dex::Sectioning& sec, OutputSink& out) const
 {
-  std::string result;
-
   for (int i(0); i < (sec.depth - dex::Sectioning::Part) + 1; ++i)
-    result.push_back('#');
+    out << '#';
 
-  result.push_back(' ');
-
-  result += sec.name + "\n\n";
+  out << ' ' << sec.name << "\n\n";
 
   for (const auto& c : sec.content)
   {
-    result += stringify_domnode(*c) + "\n\n";
+    write_domnode(*c, out);
+    out << "\n\n";
   }
-
-  return result;
 }
 
 std::string MarkdownStringifier::stringify_tableofcontents(const dex::TableOfContents& toc) const
@@ -21,10 +21,8 @@ public:
   explicit MarkdownStringifier(LiquidExporter& exp);
 
 protected:
-  void selected() override;
-
-  std::string stringify_list(const dex::List& list) const override;
-  std::string stringify_listitem(const dex::ListItem& li) const override;
+  void write_list(const dex::List& list, OutputSink& out) const override;
+  void write_listitem(const dex::ListItem& li, OutputSink& out) const override;
   std::string stringify_paragraph(const dex::Paragraph& par) const override;
   std::string stringify_image(const dex::Image& img) const override;
   std::string stringify_beginsince(const dex::BeginSince& bsince) const override;
@@ -39,7 +37,7 @@ protected:
   std::string stringify_frontmatter(const dex::FrontMatter& fm) const override;
   std::string stringify_mainmatter(const dex::MainMatter& mm) const override;
   std::string stringify_backmatter(const dex::BackMatter& bm) const override;
-  std::string stringify_section(const dex::Sectioning& sec) const override;
+  void write_section(const dex::Sectioning& sec, OutputSink& out) const override;
   std::string stringify_tableofcontents(const dex::TableOfContents& toc) const override;
   std::string stringify_index(const dex::Index& idx) const override;
 };
@@ -0,0 +1,107 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/output-queue.h"
+
+#include "dex/output/output-sync.h"
+
+#include <algorithm>
+
+namespace dex
+{
+
+OutputQueue::OutputQueue(OutputSync& sync, size_t capacity, size_t threads)
+  : m_sync(sync),
+    m_capacity(std::max<size_t>(capacity, 1))
+{
+  threads = std::max<size_t>(threads, 1);
+
+  for (size_t i(0); i < threads; ++i)
+    m_threads.emplace_back([this]() { run(); });
+}
+
+OutputQueue::~OutputQueue()
+{
+  join();
+}
+
+void OutputQueue::write(std::filesystem::path file, std::string data)
+{
+  std::unique_lock<std::mutex> lock{ m_mutex };
+  m_not_full.wait(lock, [this]() { return m_items.size() < m_capacity || m_error; });
+
+  // after an error, the remaining files are dropped
+  if (m_error)
+    return;
+
+  m_items.push_back(Item{ std::move(file), std::move(data) });
+  lock.unlock();
+
+  m_not_empty.notify_one();
+}
+
+void OutputQueue::close()
+{
+  join();
+
+  if (m_error)
+  {
+    std::exception_ptr error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void OutputQueue::run()
+{
+  for (;;)
+  {
+    Item item;
+
+    {
+      std::unique_lock<std::mutex> lock{ m_mutex };
+      m_not_empty.wait(lock, [this]() { return !m_items.empty() || m_closed; });
+
+      if (m_items.empty())
+        return;
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+    }
+
+    m_not_full.notify_one();
+
+    try
+    {
+      m_sync.write(item.file, item.data);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock{ m_mutex };
+
+      if (!m_error)
+        m_error = std::current_exception();
+
+      m_items.clear();
+      m_not_full.notify_all();
+    }
+  }
+}
+
+void OutputQueue::join()
+{
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_closed = true;
+  }
+
+  m_not_empty.notify_all();
+
+  for (std::thread& t : m_threads)
+    t.join();
+
+  m_threads.clear();
+}
+
+} // namespace dex
@@ -0,0 +1,65 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_OUTPUTQUEUE_H
+#define DEX_OUTPUT_OUTPUTQUEUE_H
+
+#include "dex/dex-output.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dex
+{
+
+class OutputSync;
+
+// Write-behind queue: files are written by background threads while
+// the caller keeps producing the next ones.
+// write() blocks while the queue is full; the first I/O error is
+// rethrown by close().
+class DEX_OUTPUT_API OutputQueue
+{
+public:
+  explicit OutputQueue(OutputSync& sync, size_t capacity = 64, size_t threads = 1);
+  OutputQueue(const OutputQueue&) = delete;
+  ~OutputQueue();
+
+  void write(std::filesystem::path file, std::string data);
+
+  void close();
+
+  OutputQueue& operator=(const OutputQueue&) = delete;
+
+protected:
+  void run();
+  void join();
+
+private:
+  struct Item
+  {
+    std::filesystem::path file;
+    std::string data;
+  };
+
+  OutputSync& m_sync;
+  size_t m_capacity;
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::deque<Item> m_items;
+  bool m_closed = false;
+  std::exception_ptr m_error;
+  std::vector<std::thread> m_threads;
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_OUTPUTQUEUE_H
@@ -0,0 +1,186 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/output-sink.h"
+
+#include "dex/common/errors.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dex
+{
+
+OutputSink::~OutputSink()
+{
+
+}
+
+void OutputSink::finish()
+{
+
+}
+
+void OutputSink::write(const std::string& str)
+{
+  write(str.data(), str.size());
+}
+
+void OutputSink::write(char c)
+{
+  write(&c, 1);
+}
+
+OutputSink& OutputSink::operator<<(const std::string& str)
+{
+  write(str);
+  return *this;
+}
+
+OutputSink& OutputSink::operator<<(const char* str)
+{
+  write(str, std::strlen(str));
+  return *this;
+}
+
+OutputSink& OutputSink::operator<<(char c)
+{
+  write(c);
+  return *this;
+}
+
+StringSink::StringSink(std::string& str)
+  : result(str)
+{
+
+}
+
+void StringSink::write(const char* data, size_t size)
+{
+  result.append(data, size);
+}
+
+FileSink::FileSink(const std::filesystem::path& file, size_t buffer_size)
+  : m_path(file),
+    m_file(file, std::ios::binary | std::ios::trunc),
+    m_buffer(std::max<size_t>(buffer_size, 1))
+{
+  if (!m_file.is_open())
+    throw IOException{ file.string(), "could not open file for writing" };
+}
+
+FileSink::~FileSink()
+{
+  // errors are only reported by finish()
+  if (m_file.is_open())
+  {
+    flush();
+    m_file.close();
+  }
+}
+
+void FileSink::write(const char* data, size_t size)
+{
+  if (m_size + size > m_buffer.size())
+  {
+    flush();
+
+    // large chunks are not copied into the buffer
+    if (size >= m_buffer.size())
+    {
+      m_file.write(data, size);
+      return;
+    }
+  }
+
+  std::memcpy(m_buffer.data() + m_size, data, size);
+  m_size += size;
+}
+
+void FileSink::finish()
+{
+  flush();
+  m_file.close();
+
+  if (m_file.fail())
+    throw IOException{ m_path.string(), "error while writing file" };
+}
+
+void FileSink::flush()
+{
+  m_file.write(m_buffer.data(), m_size);
+  m_size = 0;
+}
+
+PostProcessingFilter::PostProcessingFilter(OutputSink& next)
+  : m_next(next)
+{
+
+}
+
+void PostProcessingFilter::write(const char* data, size_t size)
+{
+  const char* const end = data + size;
+
+  // the input is processed line by line: memchr() is vectorized by the
+  // standard library and the lines are forwarded in one piece
+  for (;;)
+  {
+    const char* nl = static_cast<const char*>(std::memchr(data, '\n', end - data));
+    const char* eol = nl ? nl : end;
+
+    const char* last = eol;
+
+    while (last != data && *(last - 1) == ' ') --last;
+
+    if (last != data)
+    {
+      flushNewlines();
+      flushSpaces();
+      m_next.write(data, last - data);
+    }
+
+    // spaces at the end of the line are only kept if the line continues
+    // in the next chunk
+    m_spaces += eol - last;
+
+    if (!nl)
+      break;
+
+    m_spaces = 0;
+    ++m_newlines;
+    data = nl + 1;
+  }
+}
+
+void PostProcessingFilter::finish()
+{
+  flushNewlines();
+  flushSpaces();
+  m_next.finish();
+}
+
+void PostProcessingFilter::flushNewlines()
+{
+  if (m_newlines == 0)
+    return;
+
+  // three or more newlines are reduced to one empty line
+  m_next.write("\n\n", m_newlines >= 3 ? 2 : m_newlines);
+  m_newlines = 0;
+}
+
+void PostProcessingFilter::flushSpaces()
+{
+  static const char spaces[] = "                                ";
+  constexpr size_t n = sizeof(spaces) - 1;
+
+  for (; m_spaces > n; m_spaces -= n)
+    m_next.write(spaces, n);
+
+  m_next.write(spaces, m_spaces);
+  m_spaces = 0;
+}
+
+} // namespace dex
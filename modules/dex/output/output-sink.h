@@ -0,0 +1,93 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_OUTPUTSINK_H
+#define DEX_OUTPUT_OUTPUTSINK_H
+
+#include "dex/dex-output.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+// Destination of generated text, written in chunks.
+class DEX_OUTPUT_API OutputSink
+{
+public:
+  virtual ~OutputSink();
+
+  virtual void write(const char* data, size_t size) = 0;
+  virtual void finish();
+
+  void write(const std::string& str);
+  void write(char c);
+
+  OutputSink& operator<<(const std::string& str);
+  OutputSink& operator<<(const char* str);
+  OutputSink& operator<<(char c);
+};
+
+class DEX_OUTPUT_API StringSink : public OutputSink
+{
+public:
+  std::string& result;
+
+public:
+  explicit StringSink(std::string& str);
+
+  using OutputSink::write;
+  void write(const char* data, size_t size) override;
+};
+
+// Buffered output to a file, finish() flushes and closes the file.
+class DEX_OUTPUT_API FileSink : public OutputSink
+{
+public:
+  explicit FileSink(const std::filesystem::path& file, size_t buffer_size = 64 * 1024);
+  ~FileSink();
+
+  using OutputSink::write;
+  void write(const char* data, size_t size) override;
+  void finish() override;
+
+protected:
+  void flush();
+
+private:
+  std::filesystem::path m_path;
+  std::ofstream m_file;
+  std::vector<char> m_buffer;
+  size_t m_size = 0;
+};
+
+// Streaming version of the post-processing of the liquid exporter:
+// removes the spaces at the end of lines and collapses runs of empty
+// lines into a single one, then forwards to another sink.
+// Only the pending spaces and newlines are buffered.
+class DEX_OUTPUT_API PostProcessingFilter : public OutputSink
+{
+public:
+  explicit PostProcessingFilter(OutputSink& next);
+
+  using OutputSink::write;
+  void write(const char* data, size_t size) override;
+  void finish() override;
+
+protected:
+  void flushNewlines();
+  void flushSpaces();
+
+private:
+  OutputSink& m_next;
+  size_t m_spaces = 0;
+  size_t m_newlines = 0;
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_OUTPUTSINK_H
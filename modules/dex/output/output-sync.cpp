@@ -0,0 +1,373 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/output-sync.h"
+
+#include "dex/output/output-sink.h"
+
+#include "dex/common/errors.h"
+#include "dex/common/file-utils.h"
+#include "dex/common/logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace dex
+{
+
+// compares the content of two files of the given size in fixed-size chunks
+static bool same_content(const std::filesystem::path& a, const std::filesystem::path& b, uintmax_t size)
+{
+  std::ifstream fa{ a, std::ios::binary };
+  std::ifstream fb{ b, std::ios::binary };
+
+  if (!fa.is_open() || !fb.is_open())
+    return false;
+
+  std::vector<char> ba(64 * 1024);
+  std::vector<char> bb(ba.size());
+
+  while (size > 0)
+  {
+    const size_t n = static_cast<size_t>(std::min<uintmax_t>(size, ba.size()));
+
+    if (!fa.read(ba.data(), n) || !fb.read(bb.data(), n))
+      return false;
+
+    if (std::memcmp(ba.data(), bb.data(), n) != 0)
+      return false;
+
+    size -= n;
+  }
+
+  return true;
+}
+
+static bool same_content(const std::filesystem::path& file, const std::string& data)
+{
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(file, ec);
+
+  if (ec || size != data.size())
+    return false;
+
+  std::ifstream stream{ file, std::ios::binary };
+
+  if (!stream.is_open())
+    return false;
+
+  std::vector<char> buffer(std::min<size_t>(data.size(), 64 * 1024));
+
+  for (size_t offset(0); offset < data.size(); )
+  {
+    const size_t n = std::min(buffer.size(), data.size() - offset);
+
+    if (!stream.read(buffer.data(), n) || std::memcmp(buffer.data(), data.data() + offset, n) != 0)
+      return false;
+
+    offset += n;
+  }
+
+  return true;
+}
+
+static bool up_to_date(const std::filesystem::path& src, const std::filesystem::path& dest)
+{
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(dest, ec);
+
+  if (ec || size != std::filesystem::file_size(src))
+    return false;
+
+  // copies get the modification time of their source, which avoids
+  // reading both files on the next run
+  const auto time = std::filesystem::last_write_time(src);
+
+  if (std::filesystem::last_write_time(dest, ec) == time && !ec)
+    return true;
+
+  if (!same_content(src, dest, size))
+    return false;
+
+  std::filesystem::last_write_time(dest, time, ec);
+  return true;
+}
+
+static bool reflink(const std::filesystem::path& src, const std::filesystem::path& dest)
+{
+#if defined(__linux__) && defined(FICLONE)
+  int in = ::open(src.c_str(), O_RDONLY);
+
+  if (in == -1)
+    return false;
+
+  int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (out == -1)
+  {
+    ::close(in);
+    return false;
+  }
+
+  const bool ok = ::ioctl(out, FICLONE, in) == 0;
+
+  ::close(out);
+  ::close(in);
+
+  return ok;
+#else
+  (void)src;
+  (void)dest;
+  return false;
+#endif // __linux__
+}
+
+OutputSync::OutputSync(std::filesystem::path dir)
+  : m_dir(std::filesystem::absolute(dir).lexically_normal())
+{
+
+}
+
+OutputSync::~OutputSync()
+{
+
+}
+
+void OutputSync::write(const std::filesystem::path& file, const std::string& data)
+{
+  if (same_content(file, data))
+  {
+    ++m_unchanged;
+  }
+  else
+  {
+    createDirectories(file.parent_path());
+
+    // the file may be a hard link to a source file
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+
+    file_utils::write_file(file, data);
+    ++m_written;
+  }
+
+  produced(file);
+}
+
+void OutputSync::copy(const std::filesystem::path& src, const std::filesystem::path& dest)
+{
+  if (up_to_date(src, dest))
+  {
+    ++m_unchanged;
+  }
+  else
+  {
+    createDirectories(dest.parent_path());
+    transfer(src, dest);
+    ++m_written;
+  }
+
+  produced(dest);
+}
+
+void OutputSync::transfer(const std::filesystem::path& src, const std::filesystem::path& dest)
+{
+  std::error_code ec;
+  std::filesystem::remove(dest, ec);
+
+  if (m_copy_mode == Hardlink)
+  {
+    std::filesystem::create_hard_link(src, dest, ec);
+
+    if (!ec)
+      return;
+  }
+  else if (m_copy_mode == Reflink)
+  {
+    if (reflink(src, dest))
+    {
+      std::filesystem::last_write_time(dest, std::filesystem::last_write_time(src), ec);
+      return;
+    }
+
+    std::filesystem::remove(dest, ec);
+  }
+
+  std::filesystem::copy_file(src, dest, std::filesystem::copy_options::overwrite_existing);
+  std::filesystem::last_write_time(dest, std::filesystem::last_write_time(src), ec);
+}
+
+void OutputSync::replace(const std::filesystem::path& file, const std::filesystem::path& dest)
+{
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(dest, ec);
+
+  if (!ec && size == std::filesystem::file_size(file) && same_content(file, dest, size))
+  {
+    std::filesystem::remove(file);
+    ++m_unchanged;
+  }
+  else
+  {
+    createDirectories(dest.parent_path());
+    std::filesystem::rename(file, dest);
+    ++m_written;
+  }
+
+  produced(dest);
+}
+
+void OutputSync::stream(const std::filesystem::path& dest, const std::function<void(OutputSink&)>& func)
+{
+  const std::filesystem::path tmp = dest.string() + ".tmp";
+
+  createDirectories(dest.parent_path());
+
+  try
+  {
+    {
+      FileSink sink{ tmp };
+      func(sink);
+      sink.finish();
+    }
+
+    replace(tmp, dest);
+  }
+  catch (...)
+  {
+    std::error_code ec;
+    std::filesystem::remove(tmp, ec);
+    throw;
+  }
+}
+
+void OutputSync::keep(const std::filesystem::path& file)
+{
+  if (!std::filesystem::exists(file))
+    return;
+
+  ++m_unchanged;
+  produced(file);
+}
+
+OutputSync::Summary OutputSync::summary() const
+{
+  Summary result;
+  result.written = m_written;
+  result.unchanged = m_unchanged;
+  result.removed = m_removed;
+  return result;
+}
+
+void OutputSync::prune(const std::vector<std::filesystem::path>& paths)
+{
+  for (const std::filesystem::path& p : paths)
+  {
+    const std::filesystem::path target = (m_dir / p).lexically_normal();
+
+    if (std::filesystem::is_directory(target))
+    {
+      pruneDirectory(target);
+
+      if (std::filesystem::is_empty(target))
+        std::filesystem::remove(target);
+    }
+    else if (std::filesystem::exists(target))
+    {
+      pruneFile(target);
+    }
+  }
+}
+
+OutputSync::Summary OutputSync::finish()
+{
+  if (std::filesystem::exists(m_dir))
+    pruneDirectory(m_dir);
+
+  return summary();
+}
+
+void OutputSync::pruneFile(const std::filesystem::path& file)
+{
+  if (!m_produced.count(file))
+  {
+    std::filesystem::remove(file);
+    ++m_removed;
+  }
+}
+
+void OutputSync::pruneDirectory(const std::filesystem::path& dir)
+{
+  std::vector<std::filesystem::path> directories;
+
+  for (auto it = std::filesystem::recursive_directory_iterator(dir); it != std::filesystem::recursive_directory_iterator(); ++it)
+  {
+    const std::filesystem::path p = it->path().lexically_normal();
+
+    if (it->is_directory())
+      directories.push_back(p);
+    else
+      pruneFile(p);
+  }
+
+  // deepest directories first
+  std::sort(directories.begin(), directories.end(), [](const std::filesystem::path& a, const std::filesystem::path& b) {
+    return a.native().size() > b.native().size();
+  });
+
+  for (const std::filesystem::path& d : directories)
+  {
+    if (std::filesystem::is_empty(d))
+      std::filesystem::remove(d);
+  }
+}
+
+void OutputSync::produced(const std::filesystem::path& file)
+{
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_produced.insert(std::filesystem::absolute(file).lexically_normal());
+}
+
+void OutputSync::createDirectories(const std::filesystem::path& dir)
+{
+  if (dir.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    if (m_directories.count(dir))
+      return;
+  }
+
+  if (!std::filesystem::exists(dir))
+  {
+    // the directory may be created concurrently by another thread
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    if (!std::filesystem::is_directory(dir))
+      throw IOException{ dir.string(), "could not create directory" };
+  }
+
+  std::lock_guard<std::mutex> lock{ m_mutex };
+  m_directories.insert(dir);
+}
+
+void log_summary(const OutputSync::Summary& summary)
+{
+  log::info() << "output: " << int(summary.written) << " file(s) written, "
+    << int(summary.unchanged) << " unchanged, " << int(summary.removed) << " removed";
+}
+
+} // namespace dex
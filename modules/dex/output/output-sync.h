@@ -0,0 +1,117 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_OUTPUTSYNC_H
+#define DEX_OUTPUT_OUTPUTSYNC_H
+
+#include "dex/dex-output.h"
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+class OutputSink;
+
+// Keeps an output directory in sync with the files produced by an
+// exporter: files are only written when their content changes, and
+// files that were not produced are removed by prune() or finish().
+// write(), copy() and keep() can be called from several threads.
+class DEX_OUTPUT_API OutputSync
+{
+public:
+  explicit OutputSync(std::filesystem::path dir);
+  OutputSync(const OutputSync&) = delete;
+  ~OutputSync();
+
+  const std::filesystem::path& directory() const;
+
+  // how copy() transfers files, falls back to a plain copy when links
+  // are not supported (e.g. across filesystems)
+  enum CopyMode
+  {
+    Copy,
+    Hardlink,
+    Reflink,
+  };
+
+  CopyMode copyMode() const;
+  void setCopyMode(CopyMode mode);
+
+  void write(const std::filesystem::path& file, const std::string& data);
+  void copy(const std::filesystem::path& src, const std::filesystem::path& dest);
+  void keep(const std::filesystem::path& file);
+
+  // moves a file produced elsewhere (e.g. streamed to a temporary file)
+  // to its destination, unless the destination has the same content
+  void replace(const std::filesystem::path& file, const std::filesystem::path& dest);
+
+  // streams a file to a temporary file next to its destination, then
+  // calls replace(); the temporary file is removed if anything fails
+  void stream(const std::filesystem::path& dest, const std::function<void(OutputSink&)>& func);
+
+  struct Summary
+  {
+    size_t written = 0;
+    size_t unchanged = 0;
+    size_t removed = 0;
+  };
+
+  // files written, unchanged and removed so far
+  Summary summary() const;
+
+  // removes the files that were not produced among the given files and
+  // directories (relative to directory()), for exporters that share
+  // their output directory
+  void prune(const std::vector<std::filesystem::path>& paths);
+
+  // removes all the files of the directory that were not produced
+  Summary finish();
+
+  OutputSync& operator=(const OutputSync&) = delete;
+
+protected:
+  void produced(const std::filesystem::path& file);
+  void createDirectories(const std::filesystem::path& dir);
+  void transfer(const std::filesystem::path& src, const std::filesystem::path& dest);
+  void pruneFile(const std::filesystem::path& file);
+  void pruneDirectory(const std::filesystem::path& dir);
+
+private:
+  std::filesystem::path m_dir;
+  CopyMode m_copy_mode = Copy;
+  std::mutex m_mutex;
+  std::set<std::filesystem::path> m_produced;
+  std::set<std::filesystem::path> m_directories; // known to exist
+  std::atomic<size_t> m_written{ 0 };
+  std::atomic<size_t> m_unchanged{ 0 };
+  std::atomic<size_t> m_removed{ 0 };
+};
+
+DEX_OUTPUT_API void log_summary(const OutputSync::Summary& summary);
+
+inline const std::filesystem::path& OutputSync::directory() const
+{
+  return m_dir;
+}
+
+inline OutputSync::CopyMode OutputSync::copyMode() const
+{
+  return m_copy_mode;
+}
+
+inline void OutputSync::setCopyMode(CopyMode mode)
+{
+  m_copy_mode = mode;
+}
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_OUTPUTSYNC_H
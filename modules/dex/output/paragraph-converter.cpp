@@ -28,30 +28,31 @@ void ParagraphConverter::process(const dex::ParagraphIterator begin, const dex::
     if (it.isText())
     {
       process_text(it.range().text());
+      continue;
+    }
+
+    // the metadata is accessed by reference to avoid touching its refcount
+    const dex::ParagraphMetaData& metad = it.metadata();
+
+    if (metad.is<dex::TextStyle>())
+    {
+      process_style(it, static_cast<const dex::TextStyle&>(metad).style());
+    }
+    else if (metad.is<dex::Link>())
+    {
+      process_link(it, static_cast<const dex::Link&>(metad).url());
+    }
+    else if (metad.is<dex::InlineMath>())
+    {
+      process_math(it);
+    }
+    else if (metad.is<dex::ParIndexEntry>())
+    {
+      process_index(it, metad.get<dex::ParIndexEntry>().key);
     }
     else
     {
-      if ((*it)->is<dex::TextStyle>())
-      {
-        process_style(it, std::static_pointer_cast<dex::TextStyle>(*it)->style());
-      }
-      else if ((*it)->is<dex::Link>())
-      {
-        process_link(it, std::static_pointer_cast<dex::Link>(*it)->url());
-      }
-      else if((*it)->is<dex::InlineMath>())
-      {
-        process_math(it);
-      }
-      else if ((*it)->is<dex::ParIndexEntry>())
-      {
-        std::shared_ptr<dex::ParagraphMetaData> metad = *it;
-        process_index(it, static_cast<const dex::GenericParagraphMetaData<dex::ParIndexEntry>&>(*metad).value().key);
-      }
-      else
-      {
-        process(it);
-      }
+      process(it);
     }
   }
 }
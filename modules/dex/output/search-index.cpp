@@ -0,0 +1,429 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "dex/output/search-index.h"
+
+#include "dex/output/output-sink.h"
+
+#include "dex/model/model.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace dex
+{
+
+namespace
+{
+
+using Postings = std::unordered_map<std::string, std::vector<uint32_t>>;
+
+bool is_word_char(char c)
+{
+  const unsigned char uc = static_cast<unsigned char>(c);
+  return (uc >= 'a' && uc <= 'z') || (uc >= 'A' && uc <= 'Z') || (uc >= '0' && uc <= '9') || c == '_' || uc >= 0x80;
+}
+
+bool is_upper(char c)
+{
+  return c >= 'A' && c <= 'Z';
+}
+
+bool is_lower(char c)
+{
+  return c >= 'a' && c <= 'z';
+}
+
+bool is_lower_or_digit(char c)
+{
+  return is_lower(c) || (c >= '0' && c <= '9');
+}
+
+void to_lower(std::string& str)
+{
+  for (char& c : str)
+  {
+    if (is_upper(c))
+      c = c - 'A' + 'a';
+  }
+}
+
+void add_token(std::string token, std::vector<std::string>& tokens)
+{
+  // single characters would match almost everything, they are only
+  // used as prefixes
+  if (token.size() < 2)
+    return;
+
+  to_lower(token);
+  tokens.push_back(std::move(token));
+}
+
+void collect_text(const DocumentNode& node, std::vector<std::string>& tokens)
+{
+  if (node.is<Paragraph>())
+    SearchIndex::tokenize(static_cast<const Paragraph&>(node).text(), tokens);
+
+  for (const auto& child : node.childNodes())
+    collect_text(*child, tokens);
+}
+
+// what is indexed for a target, either an entity or a document
+void collect_tokens(const Entity* entity, const Document* document, const SearchIndex::Target& target, std::vector<std::string>& tokens)
+{
+  if (entity)
+  {
+    const Entity& e = *entity;
+    SearchIndex::tokenizeName(e.name, tokens);
+    add_token(target.name, tokens);
+
+    if (e.brief.has_value())
+      SearchIndex::tokenize(*e.brief, tokens);
+
+    if (e.description)
+      collect_text(*e.description, tokens);
+  }
+  else
+  {
+    SearchIndex::tokenize(document->title, tokens);
+    collect_text(*document, tokens);
+  }
+}
+
+void write_string(OutputSink& out, const std::string& str)
+{
+  static const char* hex = "0123456789abcdef";
+
+  out.write('"');
+
+  size_t start = 0;
+
+  for (size_t i(0); i < str.size(); ++i)
+  {
+    const unsigned char c = static_cast<unsigned char>(str[i]);
+
+    if (c != '"' && c != '\\' && c >= 0x20)
+      continue;
+
+    out.write(str.data() + start, i - start);
+    start = i + 1;
+
+    switch (c)
+    {
+    case '"': out.write("\\\"", 2); break;
+    case '\\': out.write("\\\\", 2); break;
+    case '\n': out.write("\\n", 2); break;
+    case '\t': out.write("\\t", 2); break;
+    case '\r': out.write("\\r", 2); break;
+    default:
+    {
+      const char escape[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+      out.write(escape, sizeof(escape));
+    }
+    }
+  }
+
+  out.write(str.data() + start, str.size() - start);
+  out.write('"');
+}
+
+} // namespace
+
+static void add_entities(SearchIndex::Builder& builder, const Entity& e)
+{
+  builder.add(e);
+
+  // function parameters are not indexed
+  if (e.is<Namespace>())
+  {
+    for (const auto& child : static_cast<const Namespace&>(e).entities)
+      add_entities(builder, *child);
+  }
+  else if (e.is<Class>())
+  {
+    for (const auto& child : static_cast<const Class&>(e).members)
+      add_entities(builder, *child);
+  }
+  else if (e.is<Enum>())
+  {
+    for (const auto& value : static_cast<const Enum&>(e).values)
+      add_entities(builder, *value);
+  }
+}
+
+SearchIndex::Builder::Builder(const Model& model, UrlResolver url)
+  : m_model(model),
+    m_url(std::move(url))
+{
+
+}
+
+void SearchIndex::Builder::add(const Document& doc)
+{
+  std::string doc_url = m_url(doc);
+
+  if (doc_url.empty())
+    return;
+
+  m_targets.push_back(Target{ doc.title, std::move(doc_url) });
+  m_sources.push_back(Source{ nullptr, &doc });
+}
+
+void SearchIndex::Builder::add(const Entity& e)
+{
+  if (e.name.str().empty() || e.is<FunctionParameter>() || !m_model.program())
+    return;
+
+  std::string entity_url = m_url(e);
+
+  for (auto p = e.parent(); entity_url.empty() && p; p = p->parent())
+    entity_url = m_url(*p);
+
+  if (entity_url.empty())
+    return;
+
+  m_targets.push_back(Target{ m_model.program()->symbols.qualifiedName(e), std::move(entity_url) });
+  m_sources.push_back(Source{ &e, nullptr });
+}
+
+SearchIndex SearchIndex::build(const Model& model, const UrlResolver& url, size_t threads)
+{
+  Builder builder{ model, url };
+
+  for (const auto& doc : model.documents)
+    builder.add(*doc);
+
+  if (model.program())
+  {
+    add_entities(builder, *model.program()->globalNamespace());
+
+    for (const auto& m : model.program()->macros)
+      builder.add(*m);
+  }
+
+  return builder.build(threads);
+}
+
+SearchIndex SearchIndex::Builder::build(size_t threads)
+{
+  SearchIndex result;
+  result.targets = std::move(m_targets);
+  const std::vector<Source> sources = std::move(m_sources);
+  m_targets.clear();
+  m_sources.clear();
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  threads = std::max<size_t>(1, std::min(threads, sources.size()));
+
+  std::vector<Postings> postings{ threads };
+  std::atomic<size_t> next_source{ 0 };
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  auto work = [&](Postings& out) {
+    std::vector<std::string> tokens;
+
+    // a thread handles increasing indices, its postings are sorted
+    for (size_t i = next_source++; i < sources.size(); i = next_source++)
+    {
+      try
+      {
+        tokens.clear();
+        collect_tokens(sources.at(i).entity, sources.at(i).document, result.targets.at(i), tokens);
+
+        for (std::string& tok : tokens)
+        {
+          std::vector<uint32_t>& targets = out[std::move(tok)];
+
+          if (targets.empty() || targets.back() != i)
+            targets.push_back(static_cast<uint32_t>(i));
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock{ error_mutex };
+
+        if (!error)
+          error = std::current_exception();
+
+        next_source = sources.size();
+        return;
+      }
+    }
+  };
+
+  if (threads == 1)
+  {
+    work(postings.front());
+  }
+  else
+  {
+    std::vector<std::thread> workers;
+
+    for (Postings& p : postings)
+      workers.emplace_back(work, std::ref(p));
+
+    for (std::thread& t : workers)
+      t.join();
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  Postings& merged = postings.front();
+
+  for (size_t i(1); i < postings.size(); ++i)
+  {
+    for (auto& entry : postings.at(i))
+    {
+      std::vector<uint32_t>& targets = merged[entry.first];
+      const size_t mid = targets.size();
+      targets.insert(targets.end(), entry.second.begin(), entry.second.end());
+      std::inplace_merge(targets.begin(), targets.begin() + mid, targets.end());
+    }
+
+    postings.at(i).clear();
+  }
+
+  result.terms.reserve(merged.size());
+
+  for (auto& entry : merged)
+    result.terms.push_back(Term{ entry.first, std::move(entry.second) });
+
+  std::sort(result.terms.begin(), result.terms.end(), [](const Term& a, const Term& b) {
+    return a.token < b.token;
+  });
+
+  return result;
+}
+
+std::vector<uint32_t> SearchIndex::find(const std::string& prefix) const
+{
+  // terms are lower-case, a prefix may be a single character
+  std::string key = prefix;
+  to_lower(key);
+
+  auto it = std::lower_bound(terms.begin(), terms.end(), key, [](const Term& t, const std::string& k) {
+    return t.token < k;
+  });
+
+  std::vector<uint32_t> result;
+
+  for (; it != terms.end() && it->token.compare(0, key.size(), key) == 0; ++it)
+    result.insert(result.end(), it->targets.begin(), it->targets.end());
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+
+  return result;
+}
+
+void SearchIndex::write(OutputSink& out) const
+{
+  out << "{\"postings\":[";
+
+  for (size_t i(0); i < terms.size(); ++i)
+  {
+    if (i > 0)
+      out.write(',');
+
+    out.write('[');
+
+    uint32_t prev = 0;
+
+    for (size_t j(0); j < terms.at(i).targets.size(); ++j)
+    {
+      if (j > 0)
+        out.write(',');
+
+      const uint32_t t = terms.at(i).targets.at(j);
+      out << std::to_string(t - prev);
+      prev = t;
+    }
+
+    out.write(']');
+  }
+
+  out << "],\"targets\":[";
+
+  for (size_t i(0); i < targets.size(); ++i)
+  {
+    if (i > 0)
+      out.write(',');
+
+    out.write('[');
+    write_string(out, targets.at(i).name);
+    out.write(',');
+    write_string(out, targets.at(i).url);
+    out.write(']');
+  }
+
+  out << "],\"terms\":[";
+
+  for (size_t i(0); i < terms.size(); ++i)
+  {
+    if (i > 0)
+      out.write(',');
+
+    write_string(out, terms.at(i).token);
+  }
+
+  out << "]}";
+}
+
+void SearchIndex::tokenize(const std::string& text, std::vector<std::string>& tokens)
+{
+  size_t i = 0;
+
+  while (i < text.size())
+  {
+    while (i < text.size() && !is_word_char(text[i]))
+      ++i;
+
+    const size_t start = i;
+
+    while (i < text.size() && is_word_char(text[i]))
+      ++i;
+
+    if (i > start)
+      add_token(text.substr(start, i - start), tokens);
+  }
+}
+
+void SearchIndex::tokenizeName(const std::string& name, std::vector<std::string>& tokens)
+{
+  // the whole name, then its parts: "HTTPServer_base" gives
+  // "httpserver_base", "http", "server" and "base"
+  tokenize(name, tokens);
+
+  size_t start = 0;
+
+  for (size_t i(0); i <= name.size(); ++i)
+  {
+    bool boundary = i == name.size() || !is_word_char(name[i]) || name[i] == '_';
+
+    if (!boundary && i > start && is_upper(name[i]))
+    {
+      boundary = is_lower_or_digit(name[i - 1])
+        || (is_upper(name[i - 1]) && i + 1 < name.size() && is_lower(name[i + 1]));
+    }
+
+    if (!boundary)
+      continue;
+
+    // the name itself was already added by tokenize()
+    if (i > start && i - start < name.size())
+      add_token(name.substr(start, i - start), tokens);
+
+    start = (i < name.size() && (!is_word_char(name[i]) || name[i] == '_')) ? i + 1 : i;
+  }
+}
+
+} // namespace dex
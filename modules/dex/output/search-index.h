@@ -0,0 +1,101 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'dex' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef DEX_OUTPUT_SEARCHINDEX_H
+#define DEX_OUTPUT_SEARCHINDEX_H
+
+#include "dex/dex-output.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dex
+{
+
+class Document;
+class Entity;
+class Model;
+class OutputSink;
+
+namespace model
+{
+class Object;
+} // namespace model
+
+// Inverted index of the model, used to search the generated site.
+// Terms are lower-case words taken from entity names, qualified names,
+// briefs and paragraph text; they are sorted so that a prefix query
+// is a range of terms.
+class DEX_OUTPUT_API SearchIndex
+{
+public:
+  // An entity or document that has a page
+  struct Target
+  {
+    std::string name; // qualified name or document title
+    std::string url;
+  };
+
+  struct Term
+  {
+    std::string token;
+    std::vector<uint32_t> targets; // sorted
+  };
+
+  std::vector<Target> targets;
+  std::vector<Term> terms; // sorted by token
+
+  // Returns the url of an object, or an empty string if it has no page;
+  // entities without a page are indexed with the url of their parent.
+  using UrlResolver = std::function<std::string(const model::Object&)>;
+
+  // Collects the targets while the model is traversed, e.g. by an
+  // exporter that renders the pages, then builds the index.
+  class DEX_OUTPUT_API Builder
+  {
+  public:
+    Builder(const Model& model, UrlResolver url);
+
+    // objects without a page are skipped, entities without a page
+    // are indexed with the url of their parent
+    void add(const Document& doc);
+    void add(const Entity& e);
+
+    // uses 'threads' threads (0 for one per core), each thread has
+    // its own postings which are merged at the end
+    SearchIndex build(size_t threads = 0);
+
+  private:
+    struct Source
+    {
+      const Entity* entity = nullptr;
+      const Document* document = nullptr;
+    };
+
+    const Model& m_model;
+    UrlResolver m_url;
+    std::vector<Target> m_targets;
+    std::vector<Source> m_sources;
+  };
+
+  // Builds the index of all the documents and entities of the model
+  static SearchIndex build(const Model& model, const UrlResolver& url, size_t threads = 0);
+
+  std::vector<uint32_t> find(const std::string& prefix) const;
+
+  // Writes the index as compact JSON:
+  // {"postings":[[...]],"targets":[[name,url]],"terms":[...]}
+  // the postings of terms[i] are in postings[i], as deltas between
+  // consecutive target indices.
+  void write(OutputSink& out) const;
+
+  static void tokenize(const std::string& text, std::vector<std::string>& tokens);
+  static void tokenizeName(const std::string& name, std::vector<std::string>& tokens);
+};
+
+} // namespace dex
+
+#endif // DEX_OUTPUT_SEARCHINDEX_H
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include "dex/common/file-utils.h"
+#include "dex/common/string-pool.h"
 
 #include <json-toolkit/json.h>
 #include <json-toolkit/stringify.h>
@@ -10,8 +11,50 @@
 #include "catch.hpp"
 
 #include <iostream>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Catch2 works", "[catch]")
 {
   REQUIRE(true);
 }
+
+TEST_CASE("Testing string interning", "[common]")
+{
+  dex::StringPool pool;
+
+  const std::string* a = pool.intern("const std::string&");
+  const std::string* b = pool.intern(std::string("const std::string&"));
+
+  REQUIRE(a == b);
+  REQUIRE(pool.find("size_t") == nullptr);
+  REQUIRE(pool.statistics().strings == 1);
+  REQUIRE(pool.statistics().requests == 2);
+
+  dex::InternedString s1{ "bool" };
+  dex::InternedString s2{ std::string("bo") + "ol" };
+
+  REQUIRE(s1 == s2);
+  REQUIRE(&s1.str() == &s2.str());
+  REQUIRE(s1 == "bool");
+  REQUIRE(s1 != dex::InternedString("int"));
+  REQUIRE(dex::InternedString().empty());
+  REQUIRE(s1 + "&" == "bool&");
+
+  // handles created on other threads refer to the same strings
+  const size_t requests = dex::StringPool::global().statistics().requests;
+  std::vector<const std::string*> others(4);
+  std::vector<std::thread> threads;
+
+  for (size_t i(0); i < others.size(); ++i)
+    threads.emplace_back([&others, i]() { others[i] = &dex::InternedString("bool").str(); });
+
+  for (std::thread& t : threads)
+    t.join();
+
+  for (const std::string* str : others)
+    REQUIRE(str == &s1.str());
+
+  // requests of all threads are counted
+  REQUIRE(dex::StringPool::global().statistics().requests == requests + others.size());
+}
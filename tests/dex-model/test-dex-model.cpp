@@ -3,9 +3,19 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include "dex/model/display-math.h"
+#include "dex/model/frozen-program.h"
+#include "dex/model/manual.h"
+#include "dex/model/model.h"
+#include "dex/model/model-diff.h"
+#include "dex/model/model-snapshot.h"
+#include "dex/model/program.h"
 
 #include "catch.hpp"
 
+#include <algorithm>
+#include <random>
+#include <sstream>
+
 TEST_CASE("Testing math normalization", "[model]")
 {
   std::string src = "\\alpha x + \\gamma \\frac {1}{2}";
@@ -14,3 +24,306 @@ TEST_CASE("Testing math normalization", "[model]")
 
   REQUIRE(src == "\\alpha x + \\gamma \\frac{1}{2}");
 }
+
+TEST_CASE("Testing symbol table", "[model]")
+{
+  auto prog = std::make_shared<dex::Program>();
+  auto global = prog->globalNamespace();
+
+  auto std_ns = global->getOrCreateNamespace("std");
+  auto vector = std_ns->createClass("vector");
+  auto size = std::make_shared<dex::Function>("size", vector);
+  vector->members.push_back(size);
+  auto swap1 = std_ns->createFunction("swap");
+  auto swap2 = std_ns->createFunction("swap");
+
+  prog->symbols.build(global);
+
+  REQUIRE(prog->symbols.size() == 5);
+  REQUIRE(prog->symbols.qualifiedName(*size) == "std::vector::size");
+  REQUIRE(prog->symbols.find("std::vector") == vector);
+  REQUIRE(prog->symbols.lookup("std::swap").size() == 2);
+  REQUIRE(prog->symbols.lookupSuffix("vector::size").front() == size);
+
+  REQUIRE(prog->resolve("vector") == nullptr);
+  REQUIRE(prog->resolve("std::vector") == vector);
+  REQUIRE(prog->resolve("vector", size) == vector);
+  REQUIRE(prog->resolve("vector::size", std_ns) == size);
+  REQUIRE(prog->resolve("::std::swap", vector) == swap1);
+
+  prog->symbols.remove(swap1);
+  REQUIRE(prog->symbols.lookup("std::swap").size() == 1);
+  REQUIRE(prog->resolve("swap", vector) == swap2);
+
+  // entities added without being registered are found as well
+  auto list = std_ns->createClass("list");
+  REQUIRE(prog->resolve("list", size) == list);
+  REQUIRE(prog->symbols.find("std::list") == list);
+
+  // the table is not rebuilt again if nothing was created
+  prog->symbols.remove(list);
+  REQUIRE(prog->resolve("list", size) == nullptr);
+
+  // members of an anonymous namespace
+  auto anonymous = std_ns->getOrCreateNamespace("");
+  auto detail = anonymous->createFunction("detail");
+  REQUIRE(prog->resolve("detail", detail) == detail);
+  REQUIRE(prog->resolve("std::detail") == detail);
+  REQUIRE(prog->symbols.qualifiedName(*detail) == "std::detail");
+  REQUIRE(prog->symbols.qualifiedName(*anonymous) == "std");
+}
+
+TEST_CASE("Testing paragraph iterator", "[model]")
+{
+  dex::Paragraph par{ "Hello World and more" };
+  par.add<dex::TextStyle>(par.range(6, 11), "italic");
+  par.add<dex::TextStyle>(par.range(0, 11), "bold");
+  par.add<dex::Link>(par.range(16, 20), "https://example.com");
+
+  REQUIRE(par.spans().size() == 3);
+  REQUIRE(par.spans()[0].next == 2);
+  REQUIRE(par.spans()[1].next == 2);
+  REQUIRE(par.spans()[2].next == 3);
+
+  auto it = par.begin();
+  REQUIRE(!it.isText());
+  REQUIRE(it.hasChild());
+  REQUIRE(it.range().text() == "Hello World");
+
+  auto child = it.begin();
+  REQUIRE(child.isText());
+  REQUIRE(child.range().text() == "Hello ");
+  ++child;
+  REQUIRE(child.metadata().is<dex::TextStyle>());
+  REQUIRE(!child.hasChild());
+  REQUIRE(++child == it.end());
+
+  ++it;
+  REQUIRE(it.isText());
+  REQUIRE(it.range().text() == " and ");
+  ++it;
+  REQUIRE(it.metadata().is<dex::Link>());
+  REQUIRE(++it == par.end());
+}
+
+TEST_CASE("Testing paragraph spans", "[model]")
+{
+  // spans updated as sorted metadata are appended match the spans
+  // recomputed from scratch
+  std::mt19937 gen{ 42 };
+
+  for (int n(0); n < 50; ++n)
+  {
+    dex::Paragraph par{ std::string(40, 'a') };
+    std::vector<std::pair<size_t, size_t>> ranges;
+
+    for (int i(0); i < 12; ++i)
+    {
+      size_t begin = gen() % 40;
+      size_t end = begin + gen() % (41 - begin);
+      ranges.emplace_back(begin, end);
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const std::pair<size_t, size_t>& lhs, const std::pair<size_t, size_t>& rhs) {
+      return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second > rhs.second);
+      });
+
+    for (const auto& r : ranges)
+      par.add<dex::TextStyle>(par.range(r.first, r.second), "bold");
+
+    std::vector<size_t> incremental;
+
+    for (const dex::Paragraph::Span& sp : par.spans())
+      incremental.push_back(sp.next);
+
+    par.updateSpans();
+
+    std::vector<size_t> recomputed;
+
+    for (const dex::Paragraph::Span& sp : par.spans())
+      recomputed.push_back(sp.next);
+
+    REQUIRE(incremental == recomputed);
+  }
+}
+
+TEST_CASE("Testing frozen program", "[model]")
+{
+  auto prog = std::make_shared<dex::Program>();
+  auto global = prog->globalNamespace();
+
+  auto std_ns = global->getOrCreateNamespace("std");
+  auto vector = std_ns->createClass("vector");
+  auto size = std::make_shared<dex::Function>("size", vector);
+  size->return_type.type = "size_t";
+  vector->members.push_back(size);
+  auto length = std::make_shared<dex::Function>("length", vector);
+  length->return_type.type = "size_t";
+  vector->members.push_back(length);
+  prog->macros.push_back(std::make_shared<dex::Macro>("assert", std::vector<std::string>{ "expr" }));
+
+  auto frozen = prog->freeze();
+  REQUIRE(frozen->size() == 6);
+  REQUIRE(frozen->macros().size() == 1);
+  REQUIRE(frozen->name(frozen->macros().first) == "assert");
+
+  const dex::FrozenProgram::Index vec = frozen->indexOf(*vector);
+  REQUIRE(frozen->name(vec) == "vector");
+  REQUIRE(frozen->kind(frozen->parent(vec)) == dex::model::Kind::Namespace);
+  REQUIRE(frozen->children(vec).size() == 2);
+
+  const dex::FrozenProgram::Index len = frozen->children(vec).first + 1;
+  REQUIRE(&frozen->entity(len) == length.get());
+  REQUIRE(frozen->position(len) == 1);
+  REQUIRE(frozen->type(len) == "size_t");
+  REQUIRE(frozen->entitiesOfKind(dex::model::Kind::Function).size() == 2);
+  REQUIRE(&frozen->name(vec) == &vector->name.str());
+
+  // a view does not change with the program, a new one does
+  vector->members.push_back(std::make_shared<dex::Function>("clear", vector));
+  REQUIRE(frozen->entitiesOfKind(dex::model::Kind::Function).size() == 2);
+  REQUIRE(prog->freeze()->entitiesOfKind(dex::model::Kind::Function).size() == 3);
+}
+
+TEST_CASE("Testing group membership", "[model]")
+{
+  auto model = std::make_shared<dex::Model>();
+  auto global = model->getOrCreateProgram()->globalNamespace();
+
+  auto vec = global->createClass("vector");
+  auto list = global->createClass("list");
+  auto page = std::make_shared<dex::Page>("Containers");
+
+  model->groups.multiInsert({ "containers", "sequences" }, std::static_pointer_cast<dex::Entity>(vec));
+  model->groups.multiInsert({ "containers" }, std::static_pointer_cast<dex::Entity>(vec));
+  model->groups.multiInsert({ "containers" }, std::static_pointer_cast<dex::Document>(page));
+
+  REQUIRE(model->groups.groups.size() == 2);
+  REQUIRE(model->groups.get("unknown") == nullptr);
+
+  auto containers = model->groups.get("containers");
+  REQUIRE(containers->content.entities.size() == 1);
+  REQUIRE(containers->content.documents.size() == 1);
+
+  const auto& groups = model->groups.groupsOf(*vec);
+  REQUIRE(groups.size() == 2);
+  REQUIRE(groups.front() == containers);
+  REQUIRE(groups.back()->name == "sequences");
+
+  REQUIRE(model->groups.groupsOf(*page).size() == 1);
+  REQUIRE(model->groups.groupsOf(*list).empty());
+}
+
+TEST_CASE("Testing model snapshot", "[model]")
+{
+  auto model = std::make_shared<dex::Model>();
+  auto global = model->getOrCreateProgram()->globalNamespace();
+
+  auto base = global->createClass("Base");
+  auto derived = global->createClass("Derived");
+  derived->bases.push_back(dex::BaseClass{ dex::AccessSpecifier::PROTECTED, base });
+  derived->brief = "a derived class";
+  auto swap = global->createFunction("swap");
+  swap->parameters.push_back(std::make_shared<dex::FunctionParameter>("Derived&", "other", swap));
+  swap->template_parameters.push_back(std::make_shared<dex::TemplateParameter>("N", dex::TemplateNonTypeParameter("int", "0")));
+  model->program()->related.relates(swap, derived);
+
+  auto page = std::make_shared<dex::Page>("Intro");
+  auto par = std::make_shared<dex::Paragraph>("Hello World");
+  par->add<dex::TextStyle>(par->range(0, 5), "bold");
+  par->add<dex::Link>(par->range(6, 11), "https://example.com");
+  page->appendChild(par);
+  model->documents.push_back(page);
+
+  model->groups.multiInsert({ "core" }, std::static_pointer_cast<dex::Entity>(derived));
+  model->groups.multiInsert({ "core" }, std::static_pointer_cast<dex::Document>(page));
+
+  std::stringstream buffer;
+  dex::snapshot::save(*model, buffer);
+  const std::string data = buffer.str();
+  auto loaded = dex::snapshot::load(data.data(), data.size());
+
+  auto loaded_derived = std::static_pointer_cast<dex::Class>(loaded->program()->resolve("Derived"));
+  REQUIRE(loaded_derived != nullptr);
+  REQUIRE(loaded_derived->brief == "a derived class");
+  REQUIRE(loaded_derived->bases.size() == 1);
+  REQUIRE(loaded_derived->bases.front().isProtectedBase());
+  REQUIRE(loaded_derived->bases.front().base == loaded->program()->resolve("Base"));
+
+  auto loaded_swap = std::static_pointer_cast<dex::Function>(loaded->program()->resolve("swap"));
+  REQUIRE(loaded_swap->parameters.front()->type == "Derived&");
+  REQUIRE(loaded_swap->parameters.front()->parent() == loaded_swap);
+  REQUIRE(loaded_swap->template_parameters.front()->isNonTypeParameter());
+  REQUIRE(loaded_swap->template_parameters.front()->defaultValue<dex::TemplateNonTypeParameter>() == "0");
+  REQUIRE(loaded->program()->related.getRelated(loaded_swap)->the_class == loaded_derived);
+
+  REQUIRE(loaded->documents.size() == 1);
+  REQUIRE(loaded->documents.front()->doctype == "page");
+  auto loaded_par = std::static_pointer_cast<dex::Paragraph>(loaded->documents.front()->childNodes().front());
+  REQUIRE(loaded_par->text() == "Hello World");
+  REQUIRE(loaded_par->metadata().size() == 2);
+  REQUIRE(loaded_par->metadata().back()->is<dex::Link>());
+  REQUIRE(loaded_par->metadata().back()->range().text() == "World");
+
+  auto group = loaded->groups.get("core");
+  REQUIRE(group->content.entities.front() == loaded_derived);
+  REQUIRE(group->content.documents.front() == loaded->documents.front());
+
+  std::stringstream again;
+  dex::snapshot::save(*loaded, again);
+  REQUIRE(again.str() == data);
+
+  REQUIRE_THROWS(dex::snapshot::load(data.data(), data.size() - 1));
+
+  // corrupted bytes must be reported, never crash the reader
+  for (size_t i(0); i < data.size(); ++i)
+  {
+    for (unsigned char byte : { 0x00, 0x01, 0x05, 0x7f, 0xff })
+    {
+      std::string corrupted = data;
+      corrupted[i] = static_cast<char>(byte);
+
+      try
+      {
+        dex::snapshot::load(corrupted.data(), corrupted.size());
+      }
+      catch (const std::runtime_error&)
+      {
+      }
+    }
+  }
+}
+
+TEST_CASE("Testing model diff", "[model]")
+{
+  auto make_model = []() {
+    auto model = std::make_shared<dex::Model>();
+    auto global = model->getOrCreateProgram()->globalNamespace();
+    auto ns = global->getOrCreateNamespace("ns");
+    ns->createClass("A");
+    auto f = ns->createFunction("f");
+    f->return_type.type = "int";
+    model->documents.push_back(std::make_shared<dex::Page>("Intro"));
+    return model;
+  };
+
+  auto before = make_model();
+  auto after = make_model();
+
+  REQUIRE(dex::model::diff(*before, *after).empty());
+
+  auto ns = std::static_pointer_cast<dex::Namespace>(after->program()->globalNamespace()->entities.front());
+  ns->entities.back()->brief = "does f";
+  ns->createClass("B");
+  after->documents.clear();
+
+  dex::model::ModelDiff d = dex::model::diff(*before, *after);
+
+  REQUIRE(d.entities.size() == 2);
+  REQUIRE(d.entities.front().path == "ns::B");
+  REQUIRE(d.entities.front().status == dex::model::ModelDiff::Added);
+  REQUIRE(d.entities.back().path == dex::model::path(*ns->entities.at(1)));
+  REQUIRE(d.entities.back().status == dex::model::ModelDiff::Changed);
+  REQUIRE(d.documents.size() == 1);
+  REQUIRE(d.documents.front().status == dex::model::ModelDiff::Removed);
+}
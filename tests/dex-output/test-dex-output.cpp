@@ -12,10 +12,19 @@
 
 #include "dex/output/config.h"
 #include "dex/output/dir-copy.h"
+#include "dex/output/json/json-cbor.h"
 #include "dex/output/json/json-export.h"
+#include "dex/output/json/json-shards.h"
+#include "dex/output/json/json-stream.h"
+#include "dex/output/output-queue.h"
+#include "dex/output/output-sink.h"
+#include "dex/output/output-sync.h"
+#include "dex/output/search-index.h"
 
 #ifdef DEX_EXPORTER_LIQUID_ENABLED
 #include "dex/output/liquid/liquid-exporter.h"
+#include "dex/output/liquid/liquid-filters.h"
+#include "dex/output/liquid/liquid-wrapper.h"
 #endif // DEX_EXPORTER_LIQUID_ENABLED
 
 #include <json-toolkit/json.h>
@@ -23,8 +32,11 @@
 
 #include "catch.hpp"
 
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <map>
+#include <random>
 
 static std::shared_ptr<dex::Paragraph> make_par(const std::string& str)
 {
@@ -48,12 +60,14 @@ std::string get_folder_path()
 class MarkdownExport : public dex::LiquidExporter
 {
 public:
-  explicit MarkdownExport(std::shared_ptr<dex::Model> m)
-    : LiquidExporter(get_folder_path())
+  explicit MarkdownExport(std::shared_ptr<dex::Model> m, const json::Json& config = json::null)
+    : LiquidExporter(get_folder_path(), config)
   {
     setModel(m);
   }
 
+  using LiquidExporter::postProcess;
+
   ~MarkdownExport()
   {
     std::filesystem::remove_all(folderPath());
@@ -147,8 +161,429 @@ TEST_CASE("Test JSON export of a manual", "[output]")
   REQUIRE(jexport["text"].toString() == "Hello World!");
 }
 
+static std::string stream_json(const dex::Model& model)
+{
+  std::string result;
+  dex::StringSink sink{ result };
+  dex::JsonStreamExporter::write(model, sink);
+  return result;
+}
+
+// models covering most of the JSON schema
+static std::vector<std::shared_ptr<dex::Model>> json_test_models()
+{
+  std::vector<std::shared_ptr<dex::Model>> models;
+
+  models.push_back(std::make_shared<dex::Model>());
+
+  for (auto make_prog : { &dex::examples::prog_with_class, &dex::examples::prog_with_fun, &dex::examples::prog_with_var })
+  {
+    auto model = std::make_shared<dex::Model>();
+    model->setProgram(make_prog());
+    models.push_back(model);
+  }
+
+  models.push_back(dex::examples::prog_with_class_image_description());
+  models.push_back(dex::examples::prog_with_class_list_description());
+  models.push_back(dex::examples::manual());
+
+  {
+    auto model = std::make_shared<dex::Model>();
+    auto global = model->getOrCreateProgram()->globalNamespace();
+
+    auto derived = global->createClass("Derived");
+    derived->brief = "a \"derived\" class\twith\\escapes";
+    derived->members.push_back(std::make_shared<dex::Typedef>("int", "size_type", derived));
+    derived->members.push_back(std::make_shared<dex::Variable>("int", "count", "0", derived));
+
+    auto swap = global->createFunction("swap");
+    swap->parameters.push_back(std::make_shared<dex::FunctionParameter>("Derived&", "other", swap));
+    swap->specifiers = dex::FunctionSpecifier::Noexcept;
+    model->program()->related.relates(swap, derived);
+
+    auto color = global->createEnum("Color");
+    color->values.push_back(std::make_shared<dex::EnumValue>("Red", "1", color));
+    color->values.push_back(std::make_shared<dex::EnumValue>("Green", color));
+
+    model->program()->macros.push_back(std::make_shared<dex::Macro>("MAX", std::vector<std::string>{ "a", "b" }));
+
+    auto page = std::make_shared<dex::Page>("Intro");
+    auto par = std::make_shared<dex::Paragraph>("Hello World");
+    par->add<dex::TextStyle>(par->range(0, 5), "bold");
+    par->add<dex::Link>(par->range(6, 11), "https://example.com");
+    page->appendChild(par);
+    model->documents.push_back(page);
+
+    model->groups.multiInsert({ "core" }, std::static_pointer_cast<dex::Entity>(derived));
+    model->groups.multiInsert({ "core" }, std::static_pointer_cast<dex::Document>(page));
+    model->groups.multiInsert({ "core" }, derived->members.back());
+
+    models.push_back(model);
+  }
+
+  return models;
+}
+
+TEST_CASE("Test streaming JSON export", "[output]")
+{
+  std::vector<std::shared_ptr<dex::Model>> models = json_test_models();
+
+  REQUIRE(stream_json(*models.back()).find("\"$.program.global_namespace.entities[0].members[1]\"") != std::string::npos);
+
+  for (const auto& model : models)
+  {
+    REQUIRE(stream_json(*model) == json::stringify(dex::JsonExporter::serialize(*model)));
+  }
+}
+
+TEST_CASE("Test CBOR export", "[output]")
+{
+  {
+    std::string bytes;
+    dex::StringSink sink{ bytes };
+    dex::CborStreamWriter writer{ sink };
+    writer.beginArray();
+    writer.value(0);
+    writer.value(23);
+    writer.value(24);
+    writer.value(1000);
+    writer.value(-1);
+    writer.value(-500);
+    writer.value(true);
+    writer.value("a");
+    writer.endArray();
+
+    REQUIRE(bytes == std::string("\x9f\x00\x17\x18\x18\x19\x03\xe8\x20\x39\x01\xf3\xf5\x61" "a" "\xff", 16));
+  }
+
+  for (const auto& model : json_test_models())
+  {
+    std::string bytes;
+    dex::StringSink sink{ bytes };
+    dex::CborExporter::write(*model, sink);
+
+    json::Json decoded = dex::CborExporter::decode(bytes);
+    REQUIRE(json::stringify(decoded) == json::stringify(dex::JsonExporter::serialize(*model)));
+  }
+}
+
+TEST_CASE("Test output sync", "[output]")
+{
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "dex-test-sync";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  dex::file_utils::write_file(dir / "stale.txt", "stale");
+  dex::file_utils::write_file(dir / "other.txt", "other");
+  std::filesystem::create_directories(dir / "shards" / "sub");
+  dex::file_utils::write_file(dir / "shards" / "sub" / "stale.json", "{}");
+
+  dex::OutputSync sync{ dir };
+  sync.stream(dir / "a.txt", [](dex::OutputSink& out) { out << "a"; });
+
+  REQUIRE_THROWS(sync.stream(dir / "b.txt", [](dex::OutputSink& out) {
+    out << "b";
+    throw std::runtime_error("error");
+  }));
+
+  REQUIRE(dex::file_utils::read_all(dir / "a.txt") == "a");
+  REQUIRE(!std::filesystem::exists(dir / "b.txt"));
+  REQUIRE(!std::filesystem::exists(dir / "b.txt.tmp"));
+
+  REQUIRE(sync.summary().written == 1);
+  REQUIRE(std::filesystem::exists(dir / "stale.txt"));
+
+  // prune() only looks at the given files and directories
+  sync.prune({ "a.txt", "stale.txt", "shards" });
+  REQUIRE(sync.summary().removed == 2);
+  REQUIRE(std::filesystem::exists(dir / "a.txt"));
+  REQUIRE(!std::filesystem::exists(dir / "stale.txt"));
+  REQUIRE(!std::filesystem::exists(dir / "shards"));
+  REQUIRE(std::filesystem::exists(dir / "other.txt"));
+
+  dex::OutputSync::Summary summary = sync.finish();
+  REQUIRE(summary.removed == 3);
+  REQUIRE(!std::filesystem::exists(dir / "other.txt"));
+  REQUIRE(std::filesystem::exists(dir / "a.txt"));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test output sync copies", "[output]")
+{
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "dex-test-sync-copy";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir / "out");
+
+  dex::file_utils::write_file(dir / "same.txt", "same content");
+  dex::file_utils::write_file(dir / "out" / "same.txt", "same content");
+  dex::file_utils::write_file(dir / "changed.txt", "new content");
+  dex::file_utils::write_file(dir / "out" / "changed.txt", "old content");
+
+  // neither copy has the modification time of its source, contents are compared
+  std::filesystem::last_write_time(dir / "out" / "same.txt", std::filesystem::last_write_time(dir / "same.txt") - std::chrono::hours(1));
+  std::filesystem::last_write_time(dir / "out" / "changed.txt", std::filesystem::last_write_time(dir / "changed.txt") - std::chrono::hours(1));
+
+  dex::OutputSync sync{ dir / "out" };
+  sync.copy(dir / "same.txt", dir / "out" / "same.txt");
+  sync.copy(dir / "changed.txt", dir / "out" / "changed.txt");
+
+  REQUIRE(sync.summary().unchanged == 1);
+  REQUIRE(sync.summary().written == 1);
+  REQUIRE(dex::file_utils::read_all(dir / "out" / "changed.txt") == "new content");
+  REQUIRE(std::filesystem::last_write_time(dir / "out" / "same.txt") == std::filesystem::last_write_time(dir / "same.txt"));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test output queue", "[output]")
+{
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "dex-test-queue";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  {
+    dex::OutputSync sync{ dir };
+    dex::OutputQueue queue{ sync, 4, 2 };
+
+    for (int i(0); i < 32; ++i)
+      queue.write(dir / "pages" / (std::to_string(i) + ".txt"), std::to_string(i));
+
+    queue.close();
+
+    REQUIRE(sync.summary().written == 32);
+
+    for (int i(0); i < 32; ++i)
+      REQUIRE(dex::file_utils::read_all(dir / "pages" / (std::to_string(i) + ".txt")) == std::to_string(i));
+  }
+
+  // the first I/O error is rethrown by close(), and only once
+  {
+    dex::file_utils::write_file(dir / "blocker", "not a directory");
+
+    dex::OutputSync sync{ dir };
+    dex::OutputQueue queue{ sync };
+
+    queue.write(dir / "ok.txt", "ok");
+    queue.write(dir / "blocker" / "page.txt", "page");
+    queue.write(dir / "blocker" / "other.txt", "other");
+
+    REQUIRE_THROWS(queue.close());
+    REQUIRE_NOTHROW(queue.close());
+    REQUIRE(dex::file_utils::read_all(dir / "ok.txt") == "ok");
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test sharded JSON export", "[output]")
+{
+  auto model = std::make_shared<dex::Model>();
+  auto global = model->getOrCreateProgram()->globalNamespace();
+
+  auto ns = global->getOrCreateNamespace("ns");
+  auto a = ns->createClass("A");
+  auto b = std::make_shared<dex::Class>("B", a);
+  a->members.push_back(b);
+  a->members.push_back(std::make_shared<dex::Function>("f", a));
+  model->documents.push_back(std::make_shared<dex::Page>("Intro"));
+  model->groups.multiInsert({ "core" }, std::static_pointer_cast<dex::Entity>(b));
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "dex-test-shards";
+  std::filesystem::remove_all(dir);
+
+  std::map<std::string, std::string> contents;
+
+  for (size_t threads : { 1, 4 })
+  {
+    dex::OutputSync sync{ dir };
+    dex::JsonShardedExporter exporter{ *model, sync };
+    exporter.setThreads(threads);
+    exporter.write();
+    sync.finish();
+
+    REQUIRE(exporter.shards().size() == 5);
+
+    for (const auto& shard : exporter.shards())
+    {
+      const std::string content = dex::file_utils::read_all(dir / shard.file);
+
+      // output does not depend on the number of threads
+      if (contents.count(shard.file))
+        REQUIRE(contents[shard.file] == content);
+      else
+        contents[shard.file] = content;
+    }
+  }
+
+  auto shard_of = [&model, &dir](const std::shared_ptr<dex::model::Object>& obj) -> std::string {
+    dex::OutputSync sync{ dir };
+    dex::JsonShardedExporter exporter{ *model, sync };
+    exporter.write();
+
+    for (const auto& shard : exporter.shards())
+    {
+      if (shard.entity == obj || shard.document == obj)
+        return shard.file;
+    }
+
+    return "";
+  };
+
+  const std::string ns_file = shard_of(ns);
+  const std::string a_file = shard_of(a);
+  const std::string b_file = shard_of(b);
+  const std::string page_file = shard_of(model->documents.front());
+
+  REQUIRE(a_file.rfind("entities/ns.A-", 0) == 0);
+  REQUIRE(page_file.rfind("documents/page_Intro-", 0) == 0);
+
+  REQUIRE(contents.at(ns_file).find("\"shard\": \"" + a_file + "\"") != std::string::npos);
+  REQUIRE(contents.at(a_file).find("\"shard\": \"" + b_file + "\"") != std::string::npos);
+  REQUIRE(contents.at(a_file).find("\"name\": \"f\"") != std::string::npos);
+
+  const std::string manifest = dex::file_utils::read_all(dir / "manifest.json");
+  REQUIRE(manifest.find("\"path\": \"$.program.global_namespace.entities[0].entities[0].members[0]\"") != std::string::npos);
+  REQUIRE(manifest.find("\"file\": \"" + page_file + "\"") != std::string::npos);
+
+  // file names do not depend on the position of the objects in the model
+  global->entities.insert(global->entities.begin(), std::make_shared<dex::Class>("Before", global));
+  model->documents.insert(model->documents.begin(), std::make_shared<dex::Page>("Preface"));
+  REQUIRE(shard_of(a) == a_file);
+  REQUIRE(shard_of(b) == b_file);
+  REQUIRE(shard_of(model->documents.back()) == page_file);
+
+  // re-exporting a changed model removes the shards that are no longer
+  // in the manifest, other files are left untouched
+  dex::file_utils::write_file(dir / "other.txt", "other");
+  b->name = "Renamed";
+  const std::string renamed_file = shard_of(b);
+  REQUIRE(renamed_file != b_file);
+  REQUIRE(std::filesystem::exists(dir / renamed_file));
+  REQUIRE(!std::filesystem::exists(dir / b_file));
+  REQUIRE(std::filesystem::exists(dir / a_file));
+  REQUIRE(std::filesystem::exists(dir / "other.txt"));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test search index", "[output]")
+{
+  {
+    std::vector<std::string> tokens;
+    dex::SearchIndex::tokenizeName("HTTPServer_base", tokens);
+    REQUIRE(tokens == std::vector<std::string>{ "httpserver_base", "http", "server", "base" });
+  }
+
+  std::shared_ptr<dex::Model> model = json_test_models().back();
+
+  auto url = [](const dex::model::Object& obj) -> std::string {
+    if (obj.is<dex::Class>())
+      return "classes/" + static_cast<const dex::Class&>(obj).name.str() + ".md";
+    else if (obj.is<dex::Namespace>())
+      return "namespaces/global.md";
+    else if (obj.isDocument())
+      return "documents/" + static_cast<const dex::Document&>(obj).title + ".md";
+    return "";
+  };
+
+  dex::SearchIndex index = dex::SearchIndex::build(*model, url, 1);
+
+  auto find = [&index](const std::string& prefix) {
+    std::vector<std::string> names;
+    for (uint32_t t : index.find(prefix))
+      names.push_back(index.targets.at(t).name + " " + index.targets.at(t).url);
+    return names;
+  };
+
+  REQUIRE(find("Deriv") == std::vector<std::string>{ "Derived classes/Derived.md", "Derived::size_type classes/Derived.md", "Derived::count classes/Derived.md" });
+  REQUIRE(find("escape") == std::vector<std::string>{ "Derived classes/Derived.md" });
+  REQUIRE(find("hello") == std::vector<std::string>{ "Intro documents/Intro.md" });
+  REQUIRE(find("size") == std::vector<std::string>{ "Derived::size_type classes/Derived.md" });
+  REQUIRE(find("derived::c") == std::vector<std::string>{ "Derived::count classes/Derived.md" });
+  REQUIRE(find("gre") == std::vector<std::string>{ "Color::Green namespaces/global.md" });
+  REQUIRE(find("other").empty());
+  REQUIRE(find("max").empty());
+
+  // prefixes are case-insensitive, even a single character
+  REQUIRE(find("GRE") == find("gre"));
+  REQUIRE(find("D") == find("d"));
+  REQUIRE(find("D").front() == "Derived classes/Derived.md");
+  REQUIRE(find("X").empty());
+
+  std::string single;
+  {
+    dex::StringSink sink{ single };
+    index.write(sink);
+  }
+
+  std::string parallel;
+  {
+    dex::StringSink sink{ parallel };
+    dex::SearchIndex::build(*model, url, 4).write(sink);
+  }
+
+  REQUIRE(single == parallel);
+  REQUIRE(single.find("\"targets\":[[\"Intro\",\"documents/Intro.md\"],[\"Derived\",\"classes/Derived.md\"]") != std::string::npos);
+}
+
+TEST_CASE("Test output post-processing", "[output]")
+{
+  const std::string input = "Hello   \n  \n\n\nWorld  !\n\n   \n\n\nEnd  ";
+
+  std::string output;
+  dex::StringSink sink{ output };
+  dex::PostProcessingFilter filter{ sink };
+
+  // chunks boundaries must not matter
+  for (size_t i(0); i < input.size(); i += 3)
+    filter.write(input.substr(i, 3));
+
+  filter.finish();
+
+  REQUIRE(output == "Hello\n\nWorld  !\n\nEnd  ");
+}
+
 #ifdef DEX_EXPORTER_LIQUID_ENABLED
 
+TEST_CASE("Test output post-processing against the reference implementation", "[output]")
+{
+  std::mt19937 rng{ 2022 };
+  const char alphabet[] = "  \n\nabc";
+
+  MarkdownExport md_export{ std::make_shared<dex::Model>() };
+
+  for (int n(0); n < 1000; ++n)
+  {
+    std::string input;
+    const size_t len = rng() % 200;
+
+    for (size_t i(0); i < len; ++i)
+      input.push_back(alphabet[rng() % (sizeof(alphabet) - 1)]);
+
+    std::string expected = input;
+    dex::LiquidExporter::trim_right(expected);
+    dex::LiquidExporter::simplify_empty_lines(expected);
+
+    std::string output;
+    dex::StringSink sink{ output };
+    dex::PostProcessingFilter filter{ sink };
+
+    const size_t chunk_size = 1 + rng() % 32;
+
+    for (size_t i(0); i < input.size(); i += chunk_size)
+      filter.write(input.substr(i, chunk_size));
+
+    filter.finish();
+
+    REQUIRE(output == expected);
+
+    // the exporter filters pages in place
+    std::string page = input;
+    md_export.postProcess(page);
+    REQUIRE(page == expected);
+  }
+}
+
 TEST_CASE("Test Markdown export", "[output]")
 {
   {
@@ -241,4 +676,121 @@ TEST_CASE("Test Markdown export manual", "[output]")
   REQUIRE(content == expected);
 }
 
+static std::map<std::string, std::string> read_tree(const std::filesystem::path& dir)
+{
+  std::map<std::string, std::string> result;
+
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+  {
+    if (entry.is_regular_file())
+      result[std::filesystem::relative(entry.path(), dir).generic_string()] = dex::file_utils::read_all(entry.path());
+  }
+
+  return result;
+}
+
+static std::map<std::string, std::string> render_markdown(std::shared_ptr<dex::Model> model, int threads)
+{
+  json::Json config = dex::read_output_config(get_folder_path() + "/_config.yml");
+  config["threads"] = threads;
+
+  MarkdownExport md_export{ model, config };
+  md_export.render();
+
+  return read_tree(md_export.outputDir());
+}
+
+TEST_CASE("Test parallel page rendering", "[output]")
+{
+  auto model = dex::examples::manual();
+  model->setProgram(dex::examples::prog_with_class());
+
+  std::map<std::string, std::string> sequential = render_markdown(model, 1);
+  std::map<std::string, std::string> parallel = render_markdown(model, 4);
+
+  REQUIRE(sequential.size() >= 2);
+  REQUIRE(sequential == parallel);
+}
+
+TEST_CASE("Test liquid context overlay", "[output]")
+{
+  liquid::Map base;
+  base["project"] = std::string("dex");
+  base["page"] = std::string("index");
+
+  std::map<std::string, liquid::Value> variables;
+  variables["page"] = std::string("vector");
+  variables["class"] = std::string("vector");
+
+  dex::LiquidContextOverlay overlay{ base, std::move(variables) };
+
+  REQUIRE(overlay.is_map());
+  REQUIRE(overlay.propertyNames() == std::set<std::string>{ "class", "page", "project" });
+  REQUIRE(overlay.property("page").as<std::string>() == "vector");
+  REQUIRE(overlay.property("class").as<std::string>() == "vector");
+  REQUIRE(overlay.property("project").as<std::string>() == "dex");
+  REQUIRE(overlay.property("missing").isNull());
+
+  // page variables must not leak into the shared context
+  REQUIRE(base.property("page").as<std::string>() == "index");
+  REQUIRE(base.property("class").isNull());
+}
+
+TEST_CASE("Test liquid filter registry", "[output]")
+{
+  auto model = std::make_shared<dex::Model>();
+  model->setProgram(dex::examples::prog_with_class());
+
+  MarkdownExport md_export{ model };
+  dex::LiquidFilters& filters = md_export.filters();
+
+  REQUIRE(filters.has("markdown_escape"));
+  REQUIRE(filters.has("filter_by_type"));
+  REQUIRE_FALSE(filters.has("shout"));
+
+  REQUIRE(filters.apply("markdown_escape", std::string("a < b"), {}).as<std::string>() == "a \\< b");
+
+  // the dex filters also apply to member buckets
+  {
+    dex::LiquidValueCache cache;
+    liquid::Value entities = dex::to_liquid(model->program()->globalNamespace()).property("entities");
+    liquid::Array classes = filters.apply("filter_by_type", entities, { std::string("class") }).toArray();
+    REQUIRE(classes.length() == 1);
+    REQUIRE(classes.at(0).property("name").as<std::string>() == "vector");
+    REQUIRE(filters.apply("filter_by_type", entities, { std::string("enum") }).toArray().length() == 0);
+  }
+
+  filters.add("shout", [](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
+    return object.as<std::string>() + "!";
+  });
+
+  REQUIRE(filters.has("shout"));
+  REQUIRE(filters.apply("shout", std::string("hello"), {}).as<std::string>() == "hello!");
+
+  // an added filter replaces a builtin one
+  filters.add("markdown_escape", [](const liquid::Value& object, const std::vector<liquid::Value>& /* args */) -> liquid::Value {
+    return object;
+  });
+
+  REQUIRE(filters.apply("markdown_escape", std::string("a < b"), {}).as<std::string>() == "a < b");
+}
+
+TEST_CASE("Test liquid search index", "[output]")
+{
+  auto model = dex::examples::manual();
+  model->setProgram(dex::examples::prog_with_class());
+
+  json::Json config = dex::read_output_config(get_folder_path() + "/_config.yml");
+  config["search_index"] = true;
+
+  MarkdownExport md_export{ model, config };
+  md_export.render();
+
+  // the index is collected while the pages are listed
+  const std::string index = dex::file_utils::read_all(md_export.outputDir() / "search-index.json");
+  REQUIRE(index.find("[\"The manual\",\"documents/The manual.md\"]") != std::string::npos);
+  REQUIRE(index.find("[\"vector\",\"classes/vector.md\"]") != std::string::npos);
+  REQUIRE(index.find("\"contiguously\"") != std::string::npos);
+}
+
 #endif // DEX_EXPORTER_LIQUID_ENABLED